@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+ * Anti-aliased shapes for the CPU rasterizer.
+ *
+ * Coverage is estimated from the distance between the pixel centre and the edge of the shape:
+ * a pixel whose centre lies half a pixel inside the edge is fully covered, one half a pixel
+ * outside is empty, and coverage ramps linearly in between. That is exact for straight edges
+ * and within a percent or two for the curvatures drawn here, without any supersampling.
+ *
+ * Rows are processed four pixels at a time with SSE2, coverage in floats and blending in
+ * 16-bit integer lanes. The scalar path, which also finishes the last pixels of each row,
+ * evaluates the same expressions in the same order, down to scaling the coverage by a
+ * precomputed 128 * opacity, so both round to the same weights and produce identical pixels.
+ */
+
+#if defined(__SSE2__)
+inline __m128 clamp01(__m128 v){
+    return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+}
+#endif
+
+/**
+ * @brief Filled disk
+ */
+struct AaDisk {
+    float cx, cy;       /*Centre (px)*/
+    float radius;       /*Radius (px)*/
+
+    float coverage(float px, float py) const {
+        const float dx = px - cx, dy = py - cy;
+        return std::clamp(radius + 0.5f - std::sqrt(dx * dx + dy * dy), 0.0f, 1.0f);
+    }
+#if defined(__SSE2__)
+    __m128 coverage4(__m128 px, float py) const {
+        const __m128 dx = _mm_sub_ps(px, _mm_set1_ps(cx));
+        const __m128 dy = _mm_set1_ps(py - cy);
+        const __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        return clamp01(_mm_sub_ps(_mm_set1_ps(radius + 0.5f), dist));
+    }
+#endif
+};
+
+/**
+ * @brief Circle outline
+ */
+struct AaRing {
+    float cx, cy;       /*Centre (px)*/
+    float radius;       /*Radius of the centre line of the ring (px)*/
+    float half_width;   /*Half the stroke width (px)*/
+
+    float coverage(float px, float py) const {
+        const float dx = px - cx, dy = py - cy;
+        return std::clamp(half_width + 0.5f - std::fabs(std::sqrt(dx * dx + dy * dy) - radius), 0.0f, 1.0f);
+    }
+#if defined(__SSE2__)
+    __m128 coverage4(__m128 px, float py) const {
+        const __m128 dx = _mm_sub_ps(px, _mm_set1_ps(cx));
+        const __m128 dy = _mm_set1_ps(py - cy);
+        const __m128 off = _mm_sub_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy))),
+                                      _mm_set1_ps(radius));
+        const __m128 abs_off = _mm_andnot_ps(_mm_set1_ps(-0.0f), off);
+        return clamp01(_mm_sub_ps(_mm_set1_ps(half_width + 0.5f), abs_off));
+    }
+#endif
+};
+
+/**
+ * @brief Line segment with round caps
+ */
+struct AaLine {
+    float ax, ay;       /*Start (px)*/
+    float dx, dy;       /*End minus start (px)*/
+    float inv_len_sq;   /*1 / |end - start|^2, 0 for a degenerate segment*/
+    float half_width;   /*Half the stroke width (px)*/
+
+    AaLine(float x0, float y0, float x1, float y1, float width)
+        : ax(x0), ay(y0), dx(x1 - x0), dy(y1 - y0), half_width(0.5f * width) {
+        const float len_sq = dx * dx + dy * dy;
+        inv_len_sq = len_sq > 0 ? 1.0f / len_sq : 0.0f;
+    }
+
+    float coverage(float px, float py) const {
+        const float rx = px - ax, ry = py - ay;
+        const float t = std::clamp((rx * dx + ry * dy) * inv_len_sq, 0.0f, 1.0f);
+        const float ex = rx - t * dx, ey = ry - t * dy;
+        return std::clamp(half_width + 0.5f - std::sqrt(ex * ex + ey * ey), 0.0f, 1.0f);
+    }
+#if defined(__SSE2__)
+    __m128 coverage4(__m128 px, float py) const {
+        const __m128 rx = _mm_sub_ps(px, _mm_set1_ps(ax));
+        const __m128 ry = _mm_set1_ps(py - ay);
+        const __m128 vdx = _mm_set1_ps(dx), vdy = _mm_set1_ps(dy);
+        const __m128 t = clamp01(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(rx, vdx), _mm_mul_ps(ry, vdy)),
+                                            _mm_set1_ps(inv_len_sq)));
+        const __m128 ex = _mm_sub_ps(rx, _mm_mul_ps(t, vdx));
+        const __m128 ey = _mm_sub_ps(ry, _mm_mul_ps(t, vdy));
+        const __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)));
+        return clamp01(_mm_sub_ps(_mm_set1_ps(half_width + 0.5f), dist));
+    }
+#endif
+
+    /**
+     * @brief Pixel bounds, inclusive
+     */
+    void bounds(int& x0, int& y0, int& x1, int& y1) const {
+        const float pad = half_width + 1.0f;
+        x0 = static_cast<int>(std::floor(std::min(ax, ax + dx) - pad));
+        y0 = static_cast<int>(std::floor(std::min(ay, ay + dy) - pad));
+        x1 = static_cast<int>(std::ceil(std::max(ax, ax + dx) + pad));
+        y1 = static_cast<int>(std::ceil(std::max(ay, ay + dy) + pad));
+    }
+};
+
+/**
+ * @brief Blends one ARGB8888 pixel towards a colour
+ *
+ * Weights are quantised to 1/128 so that the same arithmetic fits the SSE2 16-bit lanes.
+ *
+ * @param weight: Coverage in 1/128 [int, 0 to 128]
+ */
+inline uint32_t blendPixel(uint32_t dst, uint32_t src, int weight){
+    uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8){
+        const int d = (dst >> shift) & 0xFF;
+        const int s = (src >> shift) & 0xFF;
+        out |= static_cast<uint32_t>(d + (((s - d) * weight) >> 7)) << shift;
+    }
+    return out;
+}
+
+/**
+ * @brief Blends a shape into the pixels [x0, x1] of a row
+ *
+ * @param row: First pixel of the row
+ * @param x0: First column [int]
+ * @param x1: Last column, inclusive [int]
+ * @param y: Row index [int]
+ * @param shape: Shape providing the coverage
+ * @param colour: ARGB8888 colour [uint32_t]
+ * @param opacity: Scale applied to the coverage, the colour's alpha [float]
+ */
+template <typename Shape>
+void blendShapeRow(uint32_t* row, int x0, int x1, int y, const Shape& shape, uint32_t colour, float opacity){
+    const float py = y + 0.5f;
+    const float scale = 128.0f * opacity;
+    int x = x0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i src = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(colour)), zero);
+    const __m128 lane_offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+    const __m128 scale4 = _mm_set1_ps(scale);
+    for (; x + 3 <= x1; x += 4){
+        const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lane_offsets);
+        const __m128i weight = _mm_cvtps_epi32(_mm_mul_ps(shape.coverage4(px, py), scale4));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(weight, zero)) == 0xFFFF){
+            continue;
+        }
+        // Spread each pixel's weight over its four channels
+        const __m128i weight16 = _mm_packs_epi32(weight, weight);
+        const __m128i pairs = _mm_unpacklo_epi16(weight16, weight16);
+        const __m128i w01 = _mm_unpacklo_epi32(pairs, pairs);
+        const __m128i w23 = _mm_unpackhi_epi32(pairs, pairs);
+
+        __m128i* dst = reinterpret_cast<__m128i*>(row + x);
+        const __m128i pixels = _mm_loadu_si128(dst);
+        __m128i lo = _mm_unpacklo_epi8(pixels, zero);
+        __m128i hi = _mm_unpackhi_epi8(pixels, zero);
+        lo = _mm_add_epi16(lo, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(src, lo), w01), 7));
+        hi = _mm_add_epi16(hi, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(src, hi), w23), 7));
+        _mm_storeu_si128(dst, _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; x <= x1; ++x){
+        const int weight = static_cast<int>(std::lrint(shape.coverage(x + 0.5f, py) * scale));
+        if (weight > 0){
+            row[x] = blendPixel(row[x], colour, weight);
+        }
+    }
+}
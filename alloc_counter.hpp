@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+/**
+ * @brief Debug allocation counter
+ *
+ * Builds with ORBITSIM_COUNT_ALLOCATIONS defined replace the global operator new so that
+ * every heap allocation made through it bumps a counter of the allocating thread; the main
+ * loop and test_alloc_steady_state compare the main thread's counter across frames to prove
+ * the steady state does not allocate. Background threads (snapshot and trajectory writers,
+ * frame capture) keep their own counts and do not disturb the frame loop's. Allocations made
+ * by C libraries through malloc (SDL's own bookkeeping, for instance) are not seen.
+ *
+ * The replacement operators are definitions, so this header must be included by exactly one
+ * translation unit of a program, which every executable of this repo already is.
+ */
+inline thread_local uint64_t allocation_count = 0;   /*Allocations made by the calling thread*/
+
+/**
+ * @brief Number of allocations made so far by the calling thread
+ */
+inline uint64_t allocationCount(){
+    return allocation_count;
+}
+
+#ifdef ORBITSIM_COUNT_ALLOCATIONS
+
+constexpr bool ALLOCATION_COUNTING = true;
+
+void* operator new(std::size_t size){
+    ++allocation_count;
+    if (void* ptr = std::malloc(size ? size : 1)){
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size){
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    ++allocation_count;
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+#else
+
+constexpr bool ALLOCATION_COUNTING = false;
+
+#endif
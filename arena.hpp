@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Bump allocator for data that lives for one frame
+ *
+ * Allocation moves a pointer forward inside a block; nothing is freed individually and
+ * reset() makes the whole arena available again at the end of the frame. When a frame needs
+ * more than the current block, another block is chained on, and the next reset() replaces
+ * the chain with a single block large enough for everything, so after the first few frames
+ * the arena never goes back to the heap.
+ *
+ * Only trivially destructible data belongs here, since nothing is ever destroyed.
+ */
+class FrameArena {
+public:
+    /**
+     * @brief Position in the arena that can be rewound to
+     */
+    struct Marker {
+        size_t block;
+        size_t offset;
+    };
+
+    explicit FrameArena(size_t block_size = 1 << 20){
+        addBlock(block_size);
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /**
+     * @brief Allocates uninitialised memory
+     *
+     * @param bytes: Number of bytes [size_t]
+     * @param align: Alignment, a power of two [size_t]
+     * @return [void*] The allocated memory, valid until the next reset or rewind
+     */
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)){
+        Block* block = &blocks[current];
+        size_t offset = alignUp(block->used, align);
+        if (offset + bytes > block->size){
+            // Chain a block that fits the request, reusing one left over from a rewind
+            if (current + 1 >= blocks.size() || blocks[current + 1].size < bytes + align){
+                blocks.resize(current + 1);
+                addBlock(std::max(blocks.back().size, bytes + align));
+            }
+            block = &blocks[++current];
+            block->used = 0;
+            offset = alignUp(0, align);
+        }
+        block->used = offset + bytes;
+        in_use += bytes;
+        high_water = std::max(high_water, in_use);
+        return block->memory.get() + offset;
+    }
+
+    /**
+     * @brief Allocates an uninitialised array
+     */
+    template <typename T>
+    T* alloc(size_t count){
+        static_assert(std::is_trivially_destructible_v<T>, "Arena memory is never destroyed");
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    Marker mark() const {
+        return {current, blocks[current].used};
+    }
+
+    /**
+     * @brief Releases everything allocated since a marker
+     */
+    void rewind(const Marker& marker){
+        for (size_t b = marker.block + 1; b <= current; ++b){
+            in_use -= blocks[b].used;
+            blocks[b].used = 0;
+        }
+        in_use -= blocks[marker.block].used - marker.offset;
+        blocks[marker.block].used = marker.offset;
+        current = marker.block;
+    }
+
+    /**
+     * @brief Releases everything, merging the blocks if the frame needed more than one
+     */
+    void reset(){
+        if (blocks.size() > 1){
+            size_t total = 0;
+            for (const Block& block : blocks){
+                total += block.size;
+            }
+            blocks.clear();
+            addBlock(total);
+        }
+        blocks[0].used = 0;
+        current = 0;
+        in_use = 0;
+    }
+
+    size_t used() const { return in_use; }
+    size_t highWater() const { return high_water; }
+
+    size_t capacity() const {
+        size_t total = 0;
+        for (const Block& block : blocks){
+            total += block.size;
+        }
+        return total;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> memory;
+        size_t size;
+        size_t used;
+    };
+
+    static size_t alignUp(size_t offset, size_t align){
+        return (offset + align - 1) & ~(align - 1);
+    }
+
+    void addBlock(size_t size){
+        // Blocks start max_align_t aligned, so offsets aligned within a block stay aligned
+        blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[size]), size, 0});
+    }
+
+    std::vector<Block> blocks;
+    size_t current = 0;
+    size_t in_use = 0;
+    size_t high_water = 0;
+};
+
+/**
+ * @brief Growable array living in a FrameArena
+ *
+ * Behaves like a minimal std::vector of trivially copyable elements; growing copies the
+ * elements into a larger arena allocation and abandons the old one until the arena resets.
+ * Elements are left uninitialised by resize().
+ */
+template <typename T>
+class ArenaArray {
+public:
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                  "Arena arrays hold plain data only");
+
+    ArenaArray() = default;
+
+    ArenaArray(FrameArena& frame_arena, size_t initial_capacity)
+        : arena(&frame_arena), elements(frame_arena.alloc<T>(initial_capacity)), cap(initial_capacity) {}
+
+    void push_back(const T& value){
+        if (count == cap){
+            reserve(std::max<size_t>(16, cap * 2));
+        }
+        elements[count++] = value;
+    }
+
+    void reserve(size_t new_capacity){
+        if (new_capacity <= cap){
+            return;
+        }
+        T* grown = arena->alloc<T>(new_capacity);
+        if (count){
+            std::memcpy(grown, elements, count * sizeof(T));
+        }
+        elements = grown;
+        cap = new_capacity;
+    }
+
+    void resize(size_t new_size){
+        reserve(new_size);
+        count = new_size;
+    }
+
+    void clear() { count = 0; }
+
+    T* data() { return elements; }
+    const T* data() const { return elements; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T& operator[](size_t i) { return elements[i]; }
+    const T& operator[](size_t i) const { return elements[i]; }
+    T* begin() { return elements; }
+    T* end() { return elements + count; }
+    const T* begin() const { return elements; }
+    const T* end() const { return elements + count; }
+
+private:
+    FrameArena* arena = nullptr;
+    T* elements = nullptr;
+    size_t count = 0;
+    size_t cap = 0;
+};
+
+/**
+ * @brief Registry of the per-thread arenas, for reporting
+ */
+class ArenaRegistry {
+public:
+    static ArenaRegistry& instance(){
+        static ArenaRegistry registry;
+        return registry;
+    }
+
+    FrameArena* registerArena(){
+        std::lock_guard<std::mutex> lock(mutex);
+        arenas.push_back(std::make_unique<FrameArena>());
+        return arenas.back().get();
+    }
+
+    /**
+     * @brief Sum of the high-water marks of every thread's arena (bytes)
+     */
+    size_t totalHighWater(){
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t total = 0;
+        for (const auto& arena : arenas){
+            total += arena->highWater();
+        }
+        return total;
+    }
+
+    size_t arenaCount(){
+        std::lock_guard<std::mutex> lock(mutex);
+        return arenas.size();
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::unique_ptr<FrameArena>> arenas;
+};
+
+/**
+ * @brief Frame arena of the calling thread
+ *
+ * Each thread gets its own arena on first use, so workers never contend on an allocator;
+ * whoever owns the thread's frame (the main loop, or a worker between tasks) resets it.
+ */
+inline FrameArena& threadArena(){
+    thread_local FrameArena* arena = ArenaRegistry::instance().registerArena();
+    return *arena;
+}
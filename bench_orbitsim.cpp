@@ -0,0 +1,680 @@
+// Benchmarks for the simulator hot paths
+//
+// Build: g++ -O2 -std=c++17 bench_orbitsim.cpp -o bench_orbitsim -lSDL2
+// Usage: ./bench_orbitsim [--filter <substring>] [--out <results.json>]
+//
+// Results are written as JSON (to stdout unless --out is given) so that runs from different
+// builds can be diffed and compared by scripts; progress goes to stderr.
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "orbit.hpp"
+#include "ephemeris.hpp"
+#include "event_scheduler.hpp"
+#include "conjunction.hpp"
+#include "render.hpp"
+#include "ipc.hpp"
+#include "arena.hpp"
+#include "snapshot.hpp"
+#include "software_raster.hpp"
+
+/**
+ * @brief Result of one benchmark, a name and its named metrics
+ */
+struct BenchResult {
+    std::string name;
+    std::vector<std::pair<std::string, double>> metrics;
+};
+
+/**
+ * @brief Minimal benchmark harness
+ *
+ * Runs a callable in batches long enough to be timed reliably, repeats the batch a few times
+ * and keeps the median, which is robust against the occasional preempted run.
+ */
+class BenchSuite {
+public:
+    explicit BenchSuite(std::string name_filter) : filter(std::move(name_filter)) {}
+
+    bool enabled(const std::string& name) const {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    /**
+     * @brief Measures the time of one call of a callable
+     *
+     * @param fn: Callable to measure
+     * @return [double] Median time per call (ns)
+     */
+    template <typename Fn>
+    double measure(Fn&& fn){
+        using clock = std::chrono::steady_clock;
+        // Grow the batch until it runs for at least MIN_BATCH_MS
+        size_t batch = 1;
+        while (true){
+            const auto start = clock::now();
+            for (size_t i = 0; i < batch; ++i){
+                fn();
+            }
+            const double ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+            if (ms >= MIN_BATCH_MS || batch >= (1u << 30)){
+                break;
+            }
+            batch *= ms < MIN_BATCH_MS / 16 ? 16 : 2;
+        }
+
+        double samples[SAMPLES];
+        for (double& sample : samples){
+            const auto start = clock::now();
+            for (size_t i = 0; i < batch; ++i){
+                fn();
+            }
+            sample = std::chrono::duration<double, std::nano>(clock::now() - start).count() / batch;
+        }
+        std::sort(samples, samples + SAMPLES);
+        return samples[SAMPLES / 2];
+    }
+
+    void record(BenchResult result){
+        std::cerr << "  " << result.name << std::endl;
+        results.push_back(std::move(result));
+    }
+
+    /**
+     * @brief Writes every recorded result as a JSON document
+     */
+    void writeJson(std::ostream& out) const {
+        out << "{\n  \"suite\": \"orbitsim\",\n";
+        out << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+#ifdef __OPTIMIZE__
+        out << "  \"optimized\": true,\n";
+#else
+        out << "  \"optimized\": false,\n";
+#endif
+        out << "  \"benchmarks\": [";
+        for (size_t r = 0; r < results.size(); ++r){
+            out << (r ? ",\n" : "\n") << "    {\"name\": \"" << results[r].name << "\"";
+            for (const auto& [key, value] : results[r].metrics){
+                out << ", \"" << key << "\": ";
+                if (std::isfinite(value)){
+                    out << value;
+                }
+                else {
+                    out << "null";
+                }
+            }
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+private:
+    static constexpr double MIN_BATCH_MS = 20.0;
+    static constexpr int SAMPLES = 5;
+
+    std::string filter;
+    std::vector<BenchResult> results;
+};
+
+/**
+ * @brief Fills a store with randomly placed satellites
+ *
+ * @param store: Store to fill
+ * @param count: Number of satellites to add
+ * @param eccentric: Whether the orbits are Keplerian rather than circular
+ */
+template <typename P>
+void populateStore(BasicSatelliteStore<P>& store, size_t count, bool eccentric){
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (size_t i = 0; i < count; ++i){
+        store.add(60 + 200 * unit(rng), 0.5 + 3 * unit(rng), 360 * unit(rng),
+                  eccentric ? 0.6 * unit(rng) : 0.0, 360 * unit(rng));
+    }
+}
+
+/**
+ * @brief Filled circles through the SDL software renderer
+ *
+ * @param suite: Benchmark suite to record into
+ * @param radius: Circle radius (px)
+ */
+void benchDrawFilledCircle(BenchSuite& suite, int radius){
+    const std::string name = "render/drawFilledCircle/r" + std::to_string(radius);
+    if (!suite.enabled(name)){
+        return;
+    }
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, 600, 600, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (!renderer){
+        std::cerr << "Cannot create software renderer: " << SDL_GetError() << std::endl;
+        SDL_FreeSurface(surface);
+        return;
+    }
+    const SDL_Rect viewport = {0, 0, 600, 600};
+    const double ns = suite.measure([&]{
+        drawFilledCircle(renderer, 300, 300, radius, {0, 255, 0, 255}, &viewport);
+    });
+    const double pixels = M_PI * radius * radius;
+    suite.record({name, {{"ns_per_op", ns}, {"ns_per_pixel", ns / pixels}}});
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+}
+
+/**
+ * @brief Cached disks through the SDL software renderer, the per-frame cost after the first
+ *
+ * @param suite: Benchmark suite to record into
+ * @param radius: Disk radius (px)
+ */
+void benchDiskSprite(BenchSuite& suite, int radius){
+    const std::string name = "render/DiskSprite/r" + std::to_string(radius);
+    if (!suite.enabled(name)){
+        return;
+    }
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, 600, 600, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (!renderer){
+        std::cerr << "Cannot create software renderer: " << SDL_GetError() << std::endl;
+        SDL_FreeSurface(surface);
+        return;
+    }
+    const SDL_Rect viewport = {0, 0, 600, 600};
+    {
+        DiskSprite sprite;
+        const double ns = suite.measure([&]{
+            sprite.draw(renderer, 300, 300, radius, {0, 255, 0, 255}, viewport);
+        });
+        const double pixels = M_PI * radius * radius;
+        suite.record({name, {{"ns_per_op", ns}, {"ns_per_pixel", ns / pixels},
+                             {"rebuilds", static_cast<double>(sprite.rebuilds())}}});
+    }
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+}
+
+/**
+ * @brief A frame of satellite disks through the tiled CPU rasterizer
+ *
+ * @param suite: Benchmark suite to record into
+ * @param count: Number of satellite disks
+ * @param threads: Threads rasterizing, including the caller
+ */
+void benchSoftwareRaster(BenchSuite& suite, size_t count, unsigned threads){
+    const std::string name = "render/software_raster/" + std::to_string(count) + "/t" + std::to_string(threads);
+    if (!suite.enabled(name)){
+        return;
+    }
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, 1200, 1000, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (!renderer){
+        std::cerr << "Cannot create software renderer: " << SDL_GetError() << std::endl;
+        SDL_FreeSurface(surface);
+        return;
+    }
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> across(0.0f, 1.0f);
+    FrameArena arena;
+    ArenaArray<SDL_FPoint> visible(arena, count);
+    for (size_t i = 0; i < count; ++i){
+        visible.push_back({1200 * across(rng), 1000 * across(rng)});
+    }
+    const SDL_Rect viewport = {0, 0, 1200, 1000};
+    DensityGrid density;
+    bool drawn = true;
+    {
+        WorkerPool pool(threads - 1);
+        SoftwareRaster raster;
+        const double ns = suite.measure([&]{
+            raster.begin(1200, 1000, {0, 0, 0, 255});
+            raster.disk(600, 500, 300, {0, 0, 255, 255});
+            drawSatellitesSoftware(raster, visible, LodMode::Disk, SATELLITE_RADIUS_PX, density, viewport,
+                                   {0, 255, 0, 255});
+            drawn = raster.finish(renderer, pool) && drawn;
+        });
+        if (drawn){
+            suite.record({name, {{"ns_per_op", ns}, {"ns_per_object", ns / count}}});
+        }
+    }
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+}
+
+/**
+ * @brief Anti-aliased rows blended into a frame buffer, the inner loop of the CPU rasterizer
+ *
+ * @param suite: Benchmark suite to record into
+ * @param shape_name: Name of the shape in the benchmark name
+ * @param shape: Shape to blend over the whole frame
+ */
+template <typename Shape>
+void benchAaShape(BenchSuite& suite, const char* shape_name, const Shape& shape){
+    const std::string name = std::string("render/aa_") + shape_name + "/1024";
+    if (!suite.enabled(name)){
+        return;
+    }
+    constexpr int SIDE = 1024;
+    std::vector<uint32_t> frame(SIDE * SIDE, 0xFF000000u);
+    const double ns = suite.measure([&]{
+        for (int y = 0; y < SIDE; ++y){
+            blendShapeRow(frame.data() + static_cast<size_t>(y) * SIDE, 0, SIDE - 1, y, shape, 0xFF00FF00u, 1.0f);
+        }
+    });
+    suite.record({name, {{"ns_per_op", ns}, {"ns_per_pixel", ns / (SIDE * SIDE)}}});
+}
+
+/**
+ * @brief Fills a store with an even, shuffled mix of circular, Keplerian and precessing orbits
+ */
+void populateMixedStore(SatelliteStore& store, size_t count){
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (size_t i = 0; i < count; ++i){
+        const double kind = 3 * unit(rng);
+        store.add(60 + 200 * unit(rng), 0.5 + 3 * unit(rng), 360 * unit(rng),
+                  kind < 1 ? 0.0 : 0.6 * unit(rng), 360 * unit(rng), kind < 2 ? 0.0 : 0.01 * unit(rng));
+    }
+}
+
+/**
+ * @brief Single position evaluation on a circular orbit
+ */
+void benchCalculateSatCoordinates(BenchSuite& suite){
+    const std::string name = "propagation/calculate_sat_coordinates";
+    if (!suite.enabled(name)){
+        return;
+    }
+    double angle = 0;
+    volatile float sink = 0;
+    const double ns = suite.measure([&]{
+        auto [sat_x, sat_y] = calculate_sat_coordinates(angle, 400);
+        sink = sat_x + sat_y;
+        angle += 0.37;
+    });
+    suite.record({name, {{"ns_per_op", ns}}});
+}
+
+/**
+ * @brief One simulation step of a whole store
+ */
+void benchStoreStep(BenchSuite& suite, size_t count, bool eccentric){
+    const std::string name = std::string("propagation/step/") + (eccentric ? "kepler/" : "circular/")
+                           + std::to_string(count);
+    if (!suite.enabled(name)){
+        return;
+    }
+    SatelliteStore store;
+    populateStore(store, count, eccentric);
+    const double ns = suite.measure([&]{ store.step(); });
+    suite.record({name, {{"ns_per_op", ns}, {"ns_per_object", ns / count}}});
+}
+
+/**
+ * @brief One step of a store mixing every propagator, and regrouping it from scratch
+ *
+ * The step runs one specialised kernel per propagator group; compare ns_per_object with the
+ * single-propagator steps to see what the interleaving in memory costs.
+ */
+void benchMixedStep(BenchSuite& suite, size_t count){
+    const std::string name = "propagation/step/mixed/" + std::to_string(count);
+    if (!suite.enabled(name)){
+        return;
+    }
+    SatelliteStore store;
+    populateMixedStore(store, count);
+    const double ns = suite.measure([&]{ store.step(); });
+    const double regroup_ns = suite.measure([&]{
+        store.invalidateGroups();
+        store.updateGroups();
+    });
+    suite.record({name, {{"ns_per_op", ns}, {"ns_per_object", ns / count}, {"regroup_ns_per_object", regroup_ns / count}}});
+}
+
+/**
+ * @brief Compares stepping against the closed-form jump to the same future step
+ *
+ * @param suite: Benchmark suite to record into
+ * @param count: Number of satellites
+ * @param steps: Number of steps to advance
+ * @param eccentric: Whether the orbits are Keplerian rather than circular
+ */
+void benchTimeWarp(BenchSuite& suite, size_t count, uint64_t steps, bool eccentric){
+    const std::string name = std::string("propagation/time_warp/") + (eccentric ? "kepler/" : "circular/")
+                           + std::to_string(count) + "x" + std::to_string(steps);
+    if (!suite.enabled(name)){
+        return;
+    }
+    using clock = std::chrono::steady_clock;
+    SatelliteStore stepped, jumped;
+    populateStore(stepped, count, eccentric);
+    populateStore(jumped, count, eccentric);
+
+    const auto step_start = clock::now();
+    for (uint64_t s = 0; s < steps; ++s){
+        stepped.step();
+    }
+    const double step_ms = std::chrono::duration<double, std::milli>(clock::now() - step_start).count();
+
+    const auto jump_start = clock::now();
+    jumped.propagateTo(steps);
+    const double jump_ms = std::chrono::duration<double, std::milli>(clock::now() - jump_start).count();
+
+    // Stepping accumulates rounding in the angle, the jump does not
+    double max_error = 0;
+    for (size_t i = 0; i < count; ++i){
+        max_error = std::max(max_error, static_cast<double>(std::hypot(stepped.x[i] - jumped.x[i],
+                                                                       stepped.y[i] - jumped.y[i])));
+    }
+    suite.record({name, {{"step_ms", step_ms}, {"jump_ms", jump_ms}, {"speedup", step_ms / jump_ms},
+                         {"max_diff_km", max_error}}});
+}
+
+/**
+ * @brief Throughput and accuracy of a precision policy
+ *
+ * Times one step of a whole store, then advances two more stores by stepping and by a
+ * closed-form jump and compares their positions with a double-precision jump, the reference.
+ * Float stores also start with their elements rounded to float, which is part of their error.
+ *
+ * @param suite: Benchmark suite to record into
+ * @param count: Number of satellites
+ * @param steps: Number of steps to advance for the accuracy comparison
+ * @param eccentric: Whether the orbits are Keplerian rather than circular
+ */
+template <typename P>
+void benchPrecision(BenchSuite& suite, size_t count, uint64_t steps, bool eccentric){
+    const std::string name = std::string("propagation/precision/") + P::NAME + (eccentric ? "/kepler/" : "/circular/")
+                           + std::to_string(count) + "x" + std::to_string(steps);
+    if (!suite.enabled(name)){
+        return;
+    }
+    BasicSatelliteStore<P> timed;
+    populateStore(timed, count, eccentric);
+    const double ns = suite.measure([&]{ timed.step(); });
+
+    BasicSatelliteStore<P> stepped, jumped;
+    SatelliteStore reference;
+    populateStore(stepped, count, eccentric);
+    populateStore(jumped, count, eccentric);
+    populateStore(reference, count, eccentric);
+    for (uint64_t s = 0; s < steps; ++s){
+        stepped.step();
+    }
+    jumped.propagateTo(steps);
+    reference.propagateTo(steps);
+    double step_error = 0, jump_error = 0;
+    for (size_t i = 0; i < count; ++i){
+        step_error = std::max(step_error, static_cast<double>(std::hypot(stepped.x[i] - reference.x[i],
+                                                                         stepped.y[i] - reference.y[i])));
+        jump_error = std::max(jump_error, static_cast<double>(std::hypot(jumped.x[i] - reference.x[i],
+                                                                         jumped.y[i] - reference.y[i])));
+    }
+    suite.record({name, {{"ns_per_object", ns / count}, {"step_max_error_km", step_error},
+                         {"jump_max_error_km", jump_error}}});
+}
+
+/**
+ * @brief Scheduling events at random steps, then advancing through all of them in closed form
+ *
+ * @param suite: Benchmark suite to record into
+ * @param count: Number of events, spread over 100 steps per event
+ */
+void benchEventScheduler(BenchSuite& suite, size_t count){
+    const std::string name = "events/schedule_dispatch/" + std::to_string(count);
+    if (!suite.enabled(name)){
+        return;
+    }
+    SatelliteStore store;
+    populateStore(store, 1000, false);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint64_t> step(1, 100 * count);
+    std::vector<SimEvent> events(count);
+    for (SimEvent& event : events){
+        const uint64_t at = step(rng);
+        event = {SimEvent::Rate, at, static_cast<uint32_t>(at % store.size()), {1.0, 0, 0}};
+    }
+    EventScheduler scheduler;
+    const double schedule_ns = suite.measure([&]{
+        scheduler.clear();
+        for (const SimEvent& event : events){
+            scheduler.schedule(event);
+        }
+    });
+    // Every run starts from the same state: reset the working copies by assignment, which
+    // reuses their buffers, and take the cost of that reset out of the result
+    SatelliteStore copy = store;
+    EventScheduler pending = scheduler;
+    const double reset_ns = suite.measure([&]{
+        copy = store;
+        pending = scheduler;
+    });
+    const double advance_ns = suite.measure([&]{
+        copy = store;
+        pending = scheduler;
+        EventEffects effects;
+        pending.advance(copy, 100 * count, effects, [&](uint64_t to){ copy.propagateTo(to); });
+    });
+    suite.record({name, {{"schedule_ns_per_event", schedule_ns / count},
+                         {"advance_ms", std::max(0.0, advance_ns - reset_ns) / 1e6},
+                         {"reset_ms", reset_ns / 1e6}}});
+}
+
+/**
+ * @brief Compares evaluating a Chebyshev ephemeris against propagating the orbits
+ *
+ * @param suite: Benchmark suite to record into
+ * @param count: Number of satellites
+ * @param steps: Length of the ephemeris window (steps)
+ * @param segment_steps: Length of a polynomial segment (steps)
+ * @param degree: Degree of the Chebyshev polynomials
+ */
+void benchEphemeris(BenchSuite& suite, size_t count, uint64_t steps, uint32_t segment_steps, int degree){
+    const std::string name = "propagation/ephemeris/" + std::to_string(count) + "/seg" +
+                             std::to_string(segment_steps) + "/deg" + std::to_string(degree);
+    if (!suite.enabled(name)){
+        return;
+    }
+    using clock = std::chrono::steady_clock;
+    SatelliteStore store;
+    populateStore(store, count, true);
+
+    const auto build_start = clock::now();
+    EphemerisCache cache;
+    cache.build(store, 0, steps, segment_steps, degree);
+    const double build_ms = std::chrono::duration<double, std::milli>(clock::now() - build_start).count();
+
+    // Scrub through the window, evaluating every satellite at each epoch
+    std::vector<float> x(count), y(count);
+    double epoch = 0.5;
+    const double eval_ns = suite.measure([&]{
+        cache.positionsAt(epoch, x.data(), y.data());
+        epoch = fmod(epoch + 7.3, static_cast<double>(steps));
+    });
+    epoch = 0.5;
+    const double prop_ns = suite.measure([&]{
+        const double elapsed = epoch - static_cast<double>(store.clock);
+        for (size_t i = 0; i < count; ++i){
+            auto [sat_x, sat_y] = store.position(i, fmod(store.angle[i] + store.rate[i] * elapsed, 360.0));
+            x[i] = sat_x;
+            y[i] = sat_y;
+        }
+        epoch = fmod(epoch + 7.3, static_cast<double>(steps));
+    });
+
+    suite.record({name, {{"build_ms", build_ms}, {"eval_ns_per_object", eval_ns / count},
+                         {"propagate_ns_per_object", prop_ns / count},
+                         {"max_fit_error_km", cache.maxFitError()},
+                         {"bytes_per_object", static_cast<double>(cache.bytesPerObject())}}});
+}
+
+/**
+ * @brief Conjunction screening of a whole store
+ */
+void benchConjunction(BenchSuite& suite, size_t count){
+    const std::string name = "conjunction/screen/" + std::to_string(count);
+    if (!suite.enabled(name)){
+        return;
+    }
+    // A LEO shell moving about a kilometre per step, which is what screening sees at real
+    // timesteps rather than the coarse steps used for the propagation benchmarks
+    SatelliteStore store;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (size_t i = 0; i < count; ++i){
+        store.add(300 + 1700 * unit(rng), 0.005 + 0.01 * unit(rng), 360 * unit(rng));
+    }
+    store.step();
+    ConjunctionScreener screener;
+    size_t n_events = 0;
+    const double ns = suite.measure([&]{ n_events = screener.screen(store, 5.0f, threadArena()).size(); });
+    suite.record({name, {{"ns_per_op", ns}, {"ns_per_object", ns / count},
+                         {"events", static_cast<double>(n_events)}}});
+}
+
+/**
+ * @brief Restoring a store from a memory-mapped snapshot
+ *
+ * The snapshot is saved once up front; each iteration maps, validates and copies it into a
+ * store that already has the capacity, which is what F9 costs during a session.
+ */
+void benchSnapshotRestore(BenchSuite& suite, size_t count){
+    const std::string name = "snapshot/restore/" + std::to_string(count);
+    if (!suite.enabled(name)){
+        return;
+    }
+    const std::string path = "bench_orbitsim.snapshot";
+    SatelliteStore store;
+    populateStore(store, count, true);
+    SnapshotWriter writer;
+    std::ostringstream discard;
+    std::streambuf* cout_buf = std::cout.rdbuf(discard.rdbuf());
+    writer.save(path, store, 1);
+    while (writer.busy()){
+        usleep(1000);
+    }
+    std::cout.rdbuf(cout_buf);
+
+    SatelliteStore restored = store;
+    const double ns = suite.measure([&]{
+        SnapshotView view;
+        if (view.open(path.c_str())){
+            view.restore(restored);
+        }
+    });
+    suite.record({name, {{"ms_per_op", ns / 1e6}, {"ns_per_object", ns / count}}});
+    unlink(path.c_str());
+}
+
+/**
+ * @brief Receiving and coalescing a burst of parameter messages through getSatelliteData
+ *
+ * Uses a connected socket pair so the burst is always waiting when getSatelliteData reads,
+ * which leaves the syscalls and the parsing as the cost being measured.
+ *
+ * @param suite: Benchmark suite to record into
+ * @param burst: Slider updates sent before each read
+ */
+void benchGetSatelliteData(BenchSuite& suite, int burst){
+    const std::string name = "ipc/getSatelliteData/" + std::to_string(burst);
+    if (!suite.enabled(name)){
+        return;
+    }
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1){
+        perror("socketpair");
+        return;
+    }
+    std::string messages;
+    for (int i = 0; i < burst; ++i){
+        messages += "speed=" + std::to_string(i % 7) + "\naltitude=" + std::to_string(400 + i) + "\n";
+    }
+    MessageBuffer pending;
+    SatelliteParams params;
+    const double ns = suite.measure([&]{
+        if (write(fds[1], messages.data(), messages.size()) < 0){
+            return;
+        }
+        getSatelliteData(fds[0], pending, params);
+    });
+
+    suite.record({name, {{"ns_per_op", ns}, {"ns_per_message", ns / (2 * burst)},
+                         {"parsed_altitude", static_cast<double>(params.altitude)}}});
+    close(fds[0]);
+    close(fds[1]);
+}
+
+int main(int argc, char* argv[]){
+    std::string filter;
+    std::string out_path;
+    for (int i = 1; i < argc; ++i){
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc){
+            filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc){
+            out_path = argv[++i];
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--filter <substring>] [--out <results.json>]" << std::endl;
+            return 1;
+        }
+    }
+
+    BenchSuite suite(filter);
+    std::cerr << "Running benchmarks" << std::endl;
+
+    for (int radius : {10, 50, 127}){
+        benchDrawFilledCircle(suite, radius);
+        benchDiskSprite(suite, radius);
+    }
+    // Past DiskSprite::MAX_RADIUS_PX, drawn as spans clipped to the viewport
+    benchDiskSprite(suite, 2000);
+    for (unsigned threads : {1u, std::max(2u, std::thread::hardware_concurrency())}){
+        benchSoftwareRaster(suite, 2000, threads);
+    }
+    benchAaShape(suite, "disk", AaDisk{512, 512, 400});
+    benchAaShape(suite, "ring", AaRing{512, 512, 400, 1});
+    benchAaShape(suite, "line", AaLine(0, 0, 1024, 700, 2));
+    benchCalculateSatCoordinates(suite);
+    for (bool eccentric : {false, true}){
+        benchStoreStep(suite, 10000, eccentric);
+        benchTimeWarp(suite, 1000, 1000, eccentric);
+        benchTimeWarp(suite, 1000, 10000, eccentric);
+        benchPrecision<DoublePrecision>(suite, 10000, 1000, eccentric);
+        benchPrecision<FloatPrecision>(suite, 10000, 1000, eccentric);
+    }
+    benchMixedStep(suite, 10000);
+    benchEventScheduler(suite, 1000);
+    benchEphemeris(suite, 1000, 1000, 4, 10);
+    benchEphemeris(suite, 1000, 1000, 8, 14);
+    benchConjunction(suite, 10000);
+    benchConjunction(suite, 100000);
+    benchSnapshotRestore(suite, 1000000);
+    benchGetSatelliteData(suite, 1);
+    benchGetSatelliteData(suite, 64);
+
+    if (out_path.empty()){
+        suite.writeJson(std::cout);
+    }
+    else {
+        std::ofstream out(out_path);
+        suite.writeJson(out);
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <tuple>
+
+/**
+ * @brief World-to-screen camera
+ *
+ * The simulation works in physical units (km, origin at the centre of the Earth) and the
+ * camera maps them onto the pixels of the viewport. Zooming keeps the world point under the
+ * cursor fixed and panning moves the view by whole pixels, so the mouse interactions stay
+ * anchored to what the user is pointing at. Screen Y grows downwards and world Y follows it,
+ * so orbits keep turning the same way they always have on screen.
+ */
+struct Camera {
+    double centre_x = 0;        /*World X at the centre of the viewport (km)*/
+    double centre_y = 0;        /*World Y at the centre of the viewport (km)*/
+    double km_per_px = 50;      /*Zoom level (km per pixel)*/
+    int viewport_w = 600;       /*Viewport width (px)*/
+    int viewport_h = 600;       /*Viewport height (px)*/
+
+    static constexpr double MIN_KM_PER_PX = 0.001;
+    static constexpr double MAX_KM_PER_PX = 1e5;
+
+    /**
+     * @brief Converts world coordinates to screen coordinates
+     *
+     * @param world_x: World X (km) [double]
+     * @param world_y: World Y (km) [double]
+     * @return [std::tuple] The screen X- and Y-coordinates (px)
+     */
+    std::tuple<float, float> worldToScreen(double world_x, double world_y) const {
+        return {static_cast<float>(0.5 * viewport_w + (world_x - centre_x) / km_per_px),
+                static_cast<float>(0.5 * viewport_h + (world_y - centre_y) / km_per_px)};
+    }
+
+    /**
+     * @brief Converts screen coordinates to world coordinates
+     *
+     * @param screen_x: Screen X (px) [double]
+     * @param screen_y: Screen Y (px) [double]
+     * @return [std::tuple] The world X- and Y-coordinates (km)
+     */
+    std::tuple<double, double> screenToWorld(double screen_x, double screen_y) const {
+        return {centre_x + (screen_x - 0.5 * viewport_w) * km_per_px,
+                centre_y + (screen_y - 0.5 * viewport_h) * km_per_px};
+    }
+
+    /**
+     * @brief Converts a world length to pixels
+     */
+    float toPixels(double km) const {
+        return static_cast<float>(km / km_per_px);
+    }
+
+    /**
+     * @brief Zooms around a screen point
+     *
+     * @param screen_x: Screen X of the zoom anchor (px) [double]
+     * @param screen_y: Screen Y of the zoom anchor (px) [double]
+     * @param factor: Zoom factor, > 1 zooms in [double]
+     */
+    void zoomAt(double screen_x, double screen_y, double factor){
+        auto [anchor_x, anchor_y] = screenToWorld(screen_x, screen_y);
+        km_per_px = std::clamp(km_per_px / factor, MIN_KM_PER_PX, MAX_KM_PER_PX);
+        // Move the centre so the anchor stays under the same pixel
+        centre_x = anchor_x - (screen_x - 0.5 * viewport_w) * km_per_px;
+        centre_y = anchor_y - (screen_y - 0.5 * viewport_h) * km_per_px;
+    }
+
+    /**
+     * @brief Pans the view by a screen displacement
+     *
+     * @param dx: Horizontal displacement (px) [double]
+     * @param dy: Vertical displacement (px) [double]
+     */
+    void pan(double dx, double dy){
+        centre_x -= dx * km_per_px;
+        centre_y -= dy * km_per_px;
+    }
+
+    /**
+     * @brief Tests whether a screen-space disk overlaps the viewport
+     *
+     * @param screen_x: Screen X of the centre (px) [float]
+     * @param screen_y: Screen Y of the centre (px) [float]
+     * @param radius: Radius (px) [float]
+     * @return [bool] True if any part of the disk is inside the viewport
+     */
+    bool isVisible(float screen_x, float screen_y, float radius) const {
+        return screen_x + radius >= 0 && screen_x - radius < viewport_w &&
+               screen_y + radius >= 0 && screen_y - radius < viewport_h;
+    }
+};
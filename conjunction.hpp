@@ -0,0 +1,246 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "arena.hpp"
+#include "orbit.hpp"
+
+/**
+ * @brief A close approach between two satellites
+ */
+struct ConjunctionEvent {
+    uint32_t id_a;      /*Identifier of the first satellite*/
+    uint32_t id_b;      /*Identifier of the second satellite*/
+    float tca;          /*Time of closest approach as a fraction of the step [0, 1]*/
+    float miss_distance; /*Separation at the time of closest approach*/
+};
+
+/**
+ * @brief Conjunctions found over the steps of a frame
+ *
+ * A high time warp screens hundreds of steps per frame, each of which may find several
+ * close approaches. They are counted here and only the closest few are kept, so the
+ * frame reports them once instead of printing every event of every step.
+ */
+struct ConjunctionReport {
+    static constexpr size_t SHOWN = 3; /*Closest conjunctions kept for the report*/
+
+    struct Entry {
+        ConjunctionEvent event;
+        uint64_t step;  /*Clock of the store after the screened step*/
+    };
+
+    /**
+     * @brief Adds the conjunctions of one screened step
+     *
+     * @param events: Conjunctions returned by the screener
+     * @param step: Clock of the store after the screened step [uint64_t]
+     */
+    void add(const std::vector<ConjunctionEvent>& events, uint64_t step){
+        for (const ConjunctionEvent& conj : events){
+            ++count;
+            // Insertion into the sorted closest entries, dropping the farthest one
+            size_t i = std::min(shown, SHOWN - 1);
+            if (shown == SHOWN && conj.miss_distance >= closest[i].event.miss_distance){
+                continue;
+            }
+            for (; i > 0 && conj.miss_distance < closest[i - 1].event.miss_distance; --i){
+                closest[i] = closest[i - 1];
+            }
+            closest[i] = {conj, step};
+            shown = std::min(shown + 1, SHOWN);
+        }
+    }
+
+    void clear(){
+        count = 0;
+        shown = 0;
+    }
+
+    size_t count = 0;       /*Conjunctions found since the last clear*/
+    size_t shown = 0;       /*Valid entries of closest*/
+    Entry closest[SHOWN];   /*Closest conjunctions, nearest first*/
+};
+
+/**
+ * @brief Conjunction screener
+ *
+ * Buckets the satellites into a uniform spatial hash every step and only compares
+ * satellites that share a cell, so screening scales with the number of satellites rather
+ * than the number of pairs. Each satellite is inserted into every cell touched by the box
+ * swept during the step, grown by half the threshold on each side: two satellites that come
+ * within the threshold of each other during the step necessarily have overlapping boxes.
+ * Candidates are refined by interpolating both satellites linearly between their previous
+ * and current positions and solving for the time of closest approach within the step.
+ *
+ * The cell size follows the threshold plus the median displacement of the step, so a
+ * typical box touches a handful of cells and a few fast movers cannot inflate the cells
+ * for everyone else.
+ *
+ * Scratch data (swept boxes and hash entries) lives in the caller's frame arena and is
+ * released before returning; only the event list is kept between calls.
+ */
+class ConjunctionScreener {
+public:
+    /**
+     * @brief Screens the store for close approaches during the last step
+     *
+     * @param store: Satellite store holding the previous and current positions
+     * @param threshold: Miss distance below which a pair is reported [float]
+     * @param arena: Frame arena for the scratch data
+     * @return [const std::vector<ConjunctionEvent>&] The pairs closer than the threshold
+     */
+    const std::vector<ConjunctionEvent>& screen(const SatelliteStore& store, float threshold, FrameArena& arena){
+        events.clear();
+        const size_t n = store.size();
+        if (n < 2 || threshold <= 0){
+            return events;
+        }
+        const FrameArena::Marker scratch_start = arena.mark();
+
+        // Swept boxes and the median displacement that sets the cell size
+        const float half = 0.5f * threshold;
+        min_x = arena.alloc<float>(n);
+        min_y = arena.alloc<float>(n);
+        max_x = arena.alloc<float>(n);
+        max_y = arena.alloc<float>(n);
+        float* disp = arena.alloc<float>(n);
+        for (size_t i = 0; i < n; ++i){
+            min_x[i] = std::min(store.prev_x[i], store.x[i]) - half;
+            min_y[i] = std::min(store.prev_y[i], store.y[i]) - half;
+            max_x[i] = std::max(store.prev_x[i], store.x[i]) + half;
+            max_y[i] = std::max(store.prev_y[i], store.y[i]) + half;
+            disp[i] = std::max(max_x[i] - min_x[i], max_y[i] - min_y[i]) - threshold;
+        }
+        std::nth_element(disp, disp + n / 2, disp + n);
+        const float cell_size = threshold + disp[n / 2];
+        inv_cell = 1.0f / cell_size;
+
+        // Count the cells touched by every box
+        size_t n_entries = 0;
+        for (size_t i = 0; i < n; ++i){
+            n_entries += static_cast<size_t>(cellOf(max_x[i]) - cellOf(min_x[i]) + 1)
+                       * static_cast<size_t>(cellOf(max_y[i]) - cellOf(min_y[i]) + 1);
+        }
+
+        // Hash table sized to the next power of two above twice the entries so buckets
+        // stay sparse
+        size_t table_size = 1;
+        while (table_size < 2 * n_entries){
+            table_size <<= 1;
+        }
+        const uint32_t mask = static_cast<uint32_t>(table_size - 1);
+
+        // Counting sort of the (cell, satellite) entries by bucket
+        uint32_t* bucket_start = arena.alloc<uint32_t>(table_size + 1);
+        std::fill(bucket_start, bucket_start + table_size + 1, 0u);
+        for (size_t i = 0; i < n; ++i){
+            forEachCell(i, [&](int32_t cx, int32_t cy){
+                ++bucket_start[(hashCell(cx, cy) & mask) + 1];
+            });
+        }
+        for (size_t b = 0; b < table_size; ++b){
+            bucket_start[b + 1] += bucket_start[b];
+        }
+        uint32_t* fill = arena.alloc<uint32_t>(table_size);
+        std::copy(bucket_start, bucket_start + table_size, fill);
+        uint32_t* entry_obj = arena.alloc<uint32_t>(n_entries);
+        int32_t* entry_cx = arena.alloc<int32_t>(n_entries);
+        int32_t* entry_cy = arena.alloc<int32_t>(n_entries);
+        for (size_t i = 0; i < n; ++i){
+            forEachCell(i, [&](int32_t cx, int32_t cy){
+                const uint32_t slot = fill[hashCell(cx, cy) & mask]++;
+                entry_obj[slot] = static_cast<uint32_t>(i);
+                entry_cx[slot] = cx;
+                entry_cy[slot] = cy;
+            });
+        }
+
+        // Compare the satellites sharing a cell
+        const float threshold_sq = threshold * threshold;
+        for (size_t b = 0; b < table_size; ++b){
+            const uint32_t first = bucket_start[b];
+            const uint32_t last = bucket_start[b + 1];
+            for (uint32_t ea = first; ea + 1 < last; ++ea){
+                for (uint32_t eb = ea + 1; eb < last; ++eb){
+                    // Distinct cells can share a bucket through hash collisions
+                    if (entry_cx[ea] != entry_cx[eb] || entry_cy[ea] != entry_cy[eb]){
+                        continue;
+                    }
+                    const uint32_t i = entry_obj[ea];
+                    const uint32_t j = entry_obj[eb];
+                    if (min_x[i] > max_x[j] || min_x[j] > max_x[i] ||
+                        min_y[i] > max_y[j] || min_y[j] > max_y[i]){
+                        continue;
+                    }
+                    // A pair whose boxes span several cells shares all of them, only the
+                    // cell holding the corner of the overlap refines it
+                    if (cellOf(std::max(min_x[i], min_x[j])) != entry_cx[ea] ||
+                        cellOf(std::max(min_y[i], min_y[j])) != entry_cy[ea]){
+                        continue;
+                    }
+                    refine(store, std::min(i, j), std::max(i, j), threshold_sq);
+                }
+            }
+        }
+        arena.rewind(scratch_start);
+        return events;
+    }
+
+    const std::vector<ConjunctionEvent>& lastEvents() const { return events; }
+
+private:
+    static uint32_t hashCell(int32_t cx, int32_t cy){
+        return static_cast<uint32_t>(cx) * 73856093u ^ static_cast<uint32_t>(cy) * 19349663u;
+    }
+
+    int32_t cellOf(float coord) const {
+        return static_cast<int32_t>(std::floor(coord * inv_cell));
+    }
+
+    template <typename Fn>
+    void forEachCell(size_t i, Fn&& fn) const {
+        const int32_t cx_max = cellOf(max_x[i]);
+        const int32_t cy_max = cellOf(max_y[i]);
+        for (int32_t cy = cellOf(min_y[i]); cy <= cy_max; ++cy){
+            for (int32_t cx = cellOf(min_x[i]); cx <= cx_max; ++cx){
+                fn(cx, cy);
+            }
+        }
+    }
+
+    /**
+     * @brief Finds the time of closest approach of a candidate pair within the step
+     *
+     * Both satellites are interpolated linearly between their previous and current positions,
+     * which makes the separation a quadratic in time with a closed-form minimum.
+     */
+    void refine(const SatelliteStore& store, size_t i, size_t j, float threshold_sq){
+        const float rx = store.prev_x[i] - store.prev_x[j];
+        const float ry = store.prev_y[i] - store.prev_y[j];
+        const float vx = (store.x[i] - store.prev_x[i]) - (store.x[j] - store.prev_x[j]);
+        const float vy = (store.y[i] - store.prev_y[i]) - (store.y[j] - store.prev_y[j]);
+        const float vv = vx * vx + vy * vy;
+        float t = 0;
+        if (vv > 0){
+            t = std::clamp(-(rx * vx + ry * vy) / vv, 0.0f, 1.0f);
+        }
+        const float dx = rx + t * vx;
+        const float dy = ry + t * vy;
+        const float d_sq = dx * dx + dy * dy;
+        if (d_sq < threshold_sq){
+            events.push_back({store.id[i], store.id[j], t, std::sqrt(d_sq)});
+        }
+    }
+
+    float inv_cell = 1.0f;
+    std::vector<ConjunctionEvent> events;
+    float* min_x = nullptr;   /*Swept boxes of the call in progress, in the arena*/
+    float* min_y = nullptr;
+    float* max_x = nullptr;
+    float* max_y = nullptr;
+};
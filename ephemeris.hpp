@@ -0,0 +1,266 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+#include "orbit.hpp"
+#include "worker_pool.hpp"
+
+/**
+ * @brief Precomputed ephemeris table
+ *
+ * Fits a Chebyshev polynomial per satellite, per axis and per time segment over a window of
+ * steps, so that the position at any (fractional) step inside the window is a short Clenshaw
+ * recurrence instead of a propagation. All coefficients live in a single contiguous buffer
+ * laid out as [satellite][segment][axis][coefficient], which keeps one satellite's table
+ * together and makes the memory cost easy to account for.
+ *
+ * The fit samples the closed-form orbits at the Chebyshev nodes of each segment and then
+ * checks the polynomial against the orbit between the nodes, recording the largest error per
+ * satellite. The table is a snapshot of the store at build time: changing a satellite's
+ * parameters afterwards requires a rebuild.
+ *
+ * The simulator fits a table when a snapshot is restored, over the window the restore rewound,
+ * and replays that window from it: the window was just watched once, and every later restore
+ * of the same snapshot reuses the table instead of propagating the window again.
+ */
+class EphemerisCache {
+public:
+    static constexpr int MAX_DEGREE = 31;   /*Highest polynomial degree build() accepts*/
+
+    /**
+     * @brief Fits the ephemeris of every satellite in the store
+     *
+     * @param store: Satellites to fit, positions are taken relative to store.clock
+     * @param start: First step covered by the table [uint64_t]
+     * @param end: Last step covered by the table [uint64_t]
+     * @param segment_steps: Length of a polynomial segment (steps) [uint32_t]
+     * @param degree: Degree of the Chebyshev polynomials, 0 to MAX_DEGREE [int]
+     * @param pool: Threads fitting the satellites in parallel, optional
+     * @return [bool] False if the degree is out of range, the table is then left empty
+     */
+    bool build(const SatelliteStore& store, uint64_t start, uint64_t end, uint32_t segment_steps, int degree,
+               WorkerPool* pool = nullptr){
+        if (degree < 0 || degree > MAX_DEGREE){
+            clear();
+            return false;
+        }
+        start_step = start;
+        segment_length = std::max<uint32_t>(segment_steps, 1);
+        n_coeffs = degree + 1;
+        n_objects = store.size();
+        n_segments = (std::max(end, start + 1) - start + segment_length - 1) / segment_length;
+        coeffs.assign(n_objects * n_segments * 2 * n_coeffs, 0.0);
+        max_error.assign(n_objects, 0.0f);
+
+        // Chebyshev polynomials evaluated at the nodes, shared by every segment
+        std::vector<double> basis(n_coeffs * n_coeffs);
+        for (size_t j = 0; j < n_coeffs; ++j){
+            for (size_t k = 0; k < n_coeffs; ++k){
+                basis[j * n_coeffs + k] = cos(M_PI * j * (k + 0.5) / n_coeffs);
+            }
+        }
+
+        auto fit = [&](size_t obj){
+            double node_x[MAX_DEGREE + 1], node_y[MAX_DEGREE + 1];
+            for (size_t seg = 0; seg < n_segments; ++seg){
+                const double seg_start = static_cast<double>(start_step + seg * segment_length);
+
+                // Sample the orbit at the Chebyshev nodes of the segment
+                for (size_t k = 0; k < n_coeffs; ++k){
+                    const double u = cos(M_PI * (k + 0.5) / n_coeffs);
+                    auto [sat_x, sat_y] = exactPosition(store, obj, seg_start + 0.5 * (u + 1.0) * segment_length);
+                    node_x[k] = sat_x;
+                    node_y[k] = sat_y;
+                }
+
+                // Discrete Chebyshev transform of the samples
+                double* cx = &coeffs[offset(obj, seg)];
+                double* cy = cx + n_coeffs;
+                for (size_t j = 0; j < n_coeffs; ++j){
+                    double sum_x = 0, sum_y = 0;
+                    for (size_t k = 0; k < n_coeffs; ++k){
+                        sum_x += node_x[k] * basis[j * n_coeffs + k];
+                        sum_y += node_y[k] * basis[j * n_coeffs + k];
+                    }
+                    const double scale = (j == 0 ? 1.0 : 2.0) / n_coeffs;
+                    cx[j] = sum_x * scale;
+                    cy[j] = sum_y * scale;
+                }
+
+                // Measure the fit between the nodes, end points included
+                const int n_checks = 2 * static_cast<int>(n_coeffs) + 1;
+                for (int c = 0; c <= n_checks; ++c){
+                    const double u = 2.0 * c / n_checks - 1.0;
+                    auto [exact_x, exact_y] = exactPosition(store, obj, seg_start + 0.5 * (u + 1.0) * segment_length);
+                    auto [fit_x, fit_y] = evaluate(obj, seg, u);
+                    max_error[obj] = std::max(max_error[obj],
+                                              static_cast<float>(std::hypot(fit_x - exact_x, fit_y - exact_y)));
+                }
+            }
+        };
+        // Satellites are fitted independently, each into its own part of the buffers
+        if (pool){
+            pool->parallelFor(n_objects, fit);
+        }
+        else {
+            for (size_t obj = 0; obj < n_objects; ++obj){
+                fit(obj);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Empties the table, which then covers no step
+     */
+    void clear(){
+        n_objects = 0;
+        n_segments = 0;
+        coeffs.clear();
+        max_error.clear();
+    }
+
+    /**
+     * @brief Evaluates the position of a satellite
+     *
+     * @param obj: Index of the satellite at build time [size_t]
+     * @param step: Step to evaluate, clamped to the window of the table [double]
+     * @return [std::tuple] The X- and Y-coordinates of the satellite (km)
+     */
+    std::tuple<float, float> position(size_t obj, double step) const {
+        const double local = std::clamp(step - static_cast<double>(start_step), 0.0,
+                                        static_cast<double>(n_segments * segment_length));
+        const size_t seg = std::min(static_cast<size_t>(local / segment_length), n_segments - 1);
+        return evaluate(obj, seg, 2.0 * (local - static_cast<double>(seg * segment_length)) / segment_length - 1.0);
+    }
+
+    /**
+     * @brief Evaluates the positions of every satellite at a step
+     *
+     * @param step: Step to evaluate [double]
+     * @param x: Output X-coordinates, one per satellite (km) [float*]
+     * @param y: Output Y-coordinates, one per satellite (km) [float*]
+     */
+    void positionsAt(double step, float* x, float* y) const {
+        for (size_t obj = 0; obj < n_objects; ++obj){
+            auto [sat_x, sat_y] = position(obj, step);
+            x[obj] = sat_x;
+            y[obj] = sat_y;
+        }
+    }
+
+    bool covers(double step) const {
+        return n_segments > 0 && step >= static_cast<double>(start_step) &&
+               step <= static_cast<double>(start_step + n_segments * segment_length);
+    }
+
+    /**
+     * @brief First step covered by the table
+     */
+    uint64_t startStep() const { return start_step; }
+
+    /**
+     * @brief Moves a store forward to a step inside the table
+     *
+     * The store must hold the satellites the table was built from, unchanged. Positions come
+     * from the table; the phase and periapsis are still advanced, which costs one addition
+     * each, so the store carries on exactly once it leaves the table. As with propagateTo(),
+     * the previous position is the step just before the target.
+     *
+     * @param store: Satellites the table was built from, at a step covered by the table
+     * @param target: Step to move to, covered by the table [uint64_t]
+     */
+    void replayTo(SatelliteStore& store, uint64_t target) const {
+        if (target <= store.clock){
+            return;
+        }
+        const double elapsed = static_cast<double>(target - store.clock);
+        const bool one_step = target == store.clock + 1;
+        for (size_t obj = 0; obj < n_objects; ++obj){
+            if (one_step){
+                store.prev_x[obj] = store.x[obj];
+                store.prev_y[obj] = store.y[obj];
+            }
+            else {
+                auto [before_x, before_y] = position(obj, static_cast<double>(target - 1));
+                store.prev_x[obj] = before_x;
+                store.prev_y[obj] = before_y;
+            }
+            auto [sat_x, sat_y] = position(obj, static_cast<double>(target));
+            store.x[obj] = sat_x;
+            store.y[obj] = sat_y;
+            store.angle[obj] = fmod(store.angle[obj] + store.rate[obj] * elapsed, 360.0);
+            store.periapsis[obj] = fmod(store.periapsis[obj] + store.precession[obj] * elapsed, 360.0);
+        }
+        store.clock = target;
+    }
+
+    /**
+     * @brief Largest fit error measured for a satellite (km)
+     */
+    float fitError(size_t obj) const { return max_error[obj]; }
+
+    /**
+     * @brief Largest fit error measured over all satellites (km)
+     */
+    float maxFitError() const {
+        return max_error.empty() ? 0.0f : *std::max_element(max_error.begin(), max_error.end());
+    }
+
+    /**
+     * @brief Memory used by the table of one satellite (bytes)
+     */
+    size_t bytesPerObject() const {
+        return n_segments * 2 * n_coeffs * sizeof(double) + sizeof(float);
+    }
+
+    size_t size() const { return n_objects; }
+
+private:
+    /**
+     * @brief Closed-form position of a satellite at a fractional step
+     */
+    static std::tuple<float, float> exactPosition(const SatelliteStore& store, size_t obj, double step){
+        const double elapsed = step - static_cast<double>(store.clock);
+        return store.position(obj, fmod(store.angle[obj] + store.rate[obj] * elapsed, 360.0),
+                              fmod(store.periapsis[obj] + store.precession[obj] * elapsed, 360.0));
+    }
+
+    /**
+     * @brief Evaluates one segment of a satellite's table at u in [-1, 1]
+     */
+    std::tuple<float, float> evaluate(size_t obj, size_t seg, double u) const {
+        const double* cx = &coeffs[offset(obj, seg)];
+        return {static_cast<float>(clenshaw(cx, u)), static_cast<float>(clenshaw(cx + n_coeffs, u))};
+    }
+
+    /**
+     * @brief Sums a Chebyshev series at u in [-1, 1] with the Clenshaw recurrence
+     */
+    double clenshaw(const double* c, double u) const {
+        double b1 = 0, b2 = 0;
+        for (size_t j = n_coeffs - 1; j > 0; --j){
+            const double b0 = 2.0 * u * b1 - b2 + c[j];
+            b2 = b1;
+            b1 = b0;
+        }
+        return u * b1 - b2 + c[0];
+    }
+
+    size_t offset(size_t obj, size_t seg) const {
+        return (obj * n_segments + seg) * 2 * n_coeffs;
+    }
+
+    uint64_t start_step = 0;
+    uint32_t segment_length = 1;
+    size_t n_coeffs = 0;
+    size_t n_objects = 0;
+    size_t n_segments = 0;
+    std::vector<double> coeffs;
+    std::vector<float> max_error;
+};
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "orbit.hpp"
+#include "trace.hpp"
+
+/**
+ * @brief A change scheduled for a given simulation step
+ */
+struct SimEvent {
+    enum Kind : uint8_t {
+        Burn,       /*Impulsive manoeuvre: new altitude, rate and optionally eccentricity*/
+        Rate,       /*New rate of a satellite*/
+        Altitude,   /*New altitude of a satellite*/
+        Pause,      /*Stops the simulation at the step*/
+        Warp        /*New time warp*/
+    } kind;
+    uint64_t step;          /*Step at which the event applies*/
+    uint32_t satellite;     /*Store index of the satellite, for Burn, Rate and Altitude*/
+    /*Burn: altitude, rate, eccentricity or NaN to keep it. Rate, Altitude, Warp: the new value*/
+    double value[3];
+};
+
+/**
+ * @brief What applying events did beyond changing the store
+ *
+ * Applying events never prints; the caller reports what it collected here.
+ */
+struct EventEffects {
+    bool pause = false;         /*A Pause event was applied*/
+    uint64_t time_warp = 0;     /*Time warp set by the last Warp event, 0 if none*/
+    uint64_t burns = 0;         /*Burn events applied*/
+    uint32_t last_burn = 0;     /*Identifier of the satellite of the last burn*/
+    uint64_t last_burn_step = 0; /*Step of the last burn*/
+};
+
+/**
+ * @brief Applies one event to a store
+ *
+ * Changed satellites get their position at the current step recomputed, so the step shows
+ * the event, and their previous position is kept so the jump stays visible to screening.
+ *
+ * @param event: The event to apply [SimEvent]
+ * @param store: Satellite store at the event's step
+ * @param effects: Collects the effects on the rest of the simulation
+ */
+template <typename P>
+void applyEvent(const SimEvent& event, BasicSatelliteStore<P>& store, EventEffects& effects){
+    using Real = typename P::Real;
+    const size_t i = event.satellite;
+    switch (event.kind){
+        case SimEvent::Burn:
+            store.altitude[i] = static_cast<Real>(event.value[0]);
+            store.rate[i] = static_cast<Real>(event.value[1]);
+            if (!std::isnan(event.value[2])){
+                store.eccentricity[i] = static_cast<Real>(event.value[2]);
+                store.invalidateGroups();
+            }
+            ++effects.burns;
+            effects.last_burn = store.id[i];
+            effects.last_burn_step = store.clock;
+            break;
+        case SimEvent::Rate:
+            store.rate[i] = static_cast<Real>(event.value[0]);
+            break;
+        case SimEvent::Altitude:
+            store.altitude[i] = static_cast<Real>(event.value[0]);
+            break;
+        case SimEvent::Pause:
+            effects.pause = true;
+            return;
+        case SimEvent::Warp:
+            effects.time_warp = static_cast<uint64_t>(event.value[0]);
+            return;
+    }
+    auto [sat_x, sat_y] = store.position(i, store.angle[i]);
+    store.x[i] = sat_x;
+    store.y[i] = sat_y;
+}
+
+/**
+ * @brief Future events, ordered by the step they apply at
+ *
+ * A binary heap keyed by (step, insertion order): scheduling is O(log n), and events at the
+ * same step are dispatched together in the order they were scheduled. advance() is the
+ * intended driver: it cuts every advancement of the store at the next event, so an event
+ * applies exactly at its step however many steps a frame covers or skips in closed form.
+ */
+class EventScheduler {
+public:
+    static constexpr uint64_t NEVER = std::numeric_limits<uint64_t>::max();
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+    /**
+     * @brief Step of the earliest event, NEVER if there is none
+     */
+    uint64_t nextStep() const { return heap.empty() ? NEVER : heap.front().event.step; }
+
+    void schedule(const SimEvent& event){
+        heap.push_back({event, next_order++});
+        std::push_heap(heap.begin(), heap.end(), later);
+    }
+
+    void clear(){
+        heap.clear();
+    }
+
+    /**
+     * @brief Applies, as one batch, every event due at or before a step
+     *
+     * An event scheduled for a step the store has already passed applies at the next dispatch.
+     * Rewinding the store does not bring dispatched events back: after restoring a snapshot,
+     * clear() and schedule again the events from the restored clock on. The store is regrouped
+     * at most once for the whole batch.
+     *
+     * @return [size_t] Number of events applied
+     */
+    template <typename P>
+    size_t dispatch(BasicSatelliteStore<P>& store, EventEffects& effects){
+        size_t applied = 0;
+        while (!heap.empty() && heap.front().event.step <= store.clock){
+            std::pop_heap(heap.begin(), heap.end(), later);
+            const SimEvent event = heap.back().event;
+            heap.pop_back();
+            applyEvent(event, store, effects);
+            ++applied;
+        }
+        return applied;
+    }
+
+    /**
+     * @brief Advances a store to a target step, stopping at every event on the way
+     *
+     * Dispatches the events due at the current step, moves the store to the earlier of the
+     * target and the next event with advance_to(step), and repeats. Events due at the target
+     * itself are applied too, so the state reached already shows them.
+     *
+     * @param store: Satellite store to advance
+     * @param target: Step to reach [uint64_t]
+     * @param effects: Collects the effects of the applied events
+     * @param advance_to: Moves the store forward to the step it is given, stepping or jumping
+     * @return [bool] False if a Pause event stopped the store before the target
+     */
+    template <typename P, typename Advance>
+    bool advance(BasicSatelliteStore<P>& store, uint64_t target, EventEffects& effects, Advance&& advance_to){
+        while (true){
+            if (dispatch(store, effects) && effects.pause){
+                return store.clock >= target;
+            }
+            if (store.clock >= target){
+                return true;
+            }
+            TRACE_SCOPE("advance");
+            advance_to(std::min(target, nextStep()));
+        }
+    }
+
+private:
+    struct Entry {
+        SimEvent event;
+        uint64_t order;     /*Insertion number, breaks ties between events at the same step*/
+    };
+
+    /**
+     * @brief Heap order: the entry due last sorts first, so the earliest sits at the front
+     */
+    static bool later(const Entry& a, const Entry& b){
+        return a.event.step != b.event.step ? a.event.step > b.event.step : a.order > b.order;
+    }
+
+    std::vector<Entry> heap;
+    uint64_t next_order = 0;
+};
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+#include "camera.hpp"
+#include "render.hpp"
+
+/**
+ * @brief Screen areas that must be redrawn this frame
+ *
+ * Rectangles are clipped to the viewport and kept disjoint: a rectangle overlapping another is
+ * merged with it into their bounding box. Past MAX_RECTS the region gives up and covers the
+ * whole viewport, which is also what a large total area should lead to.
+ */
+class DirtyRegion {
+public:
+    static constexpr size_t MAX_RECTS = 64;
+
+    /**
+     * @brief Empties the region
+     *
+     * @param viewport: The viewport rectangle [SDL_Rect]
+     */
+    void reset(const SDL_Rect& viewport){
+        bounds = viewport;
+        count = 0;
+        everything = false;
+    }
+
+    /**
+     * @brief Covers the whole viewport
+     */
+    void markAll(){
+        everything = true;
+        count = 0;
+    }
+
+    void add(const SDL_Rect& rect){
+        if (everything){
+            return;
+        }
+        SDL_Rect merged;
+        if (!SDL_IntersectRect(&rect, &bounds, &merged)){
+            return;
+        }
+        // Absorb every rectangle the new one overlaps, the union can overlap further ones
+        for (size_t i = 0; i < count;){
+            if (SDL_HasIntersection(&merged, &rects[i])){
+                SDL_UnionRect(&merged, &rects[i], &merged);
+                rects[i] = rects[--count];
+                i = 0;
+            }
+            else {
+                ++i;
+            }
+        }
+        if (count == MAX_RECTS){
+            markAll();
+            return;
+        }
+        rects[count++] = merged;
+    }
+
+    bool all() const { return everything; }
+
+    /**
+     * @brief Covered pixels
+     */
+    size_t area() const {
+        if (everything){
+            return static_cast<size_t>(bounds.w) * bounds.h;
+        }
+        size_t total = 0;
+        for (size_t i = 0; i < count; ++i){
+            total += static_cast<size_t>(rects[i].w) * rects[i].h;
+        }
+        return total;
+    }
+
+    const SDL_Rect* begin() const { return rects; }
+    const SDL_Rect* end() const { return rects + count; }
+
+private:
+    SDL_Rect bounds = {0, 0, 0, 0};
+    SDL_Rect rects[MAX_RECTS];
+    size_t count = 0;
+    bool everything = false;
+};
+
+/**
+ * @brief Pixels a one-pixel line between two points may touch
+ */
+inline SDL_Rect segmentBounds(const SDL_FPoint& a, const SDL_FPoint& b){
+    const int x0 = static_cast<int>(std::floor(std::min(a.x, b.x))) - 1;
+    const int y0 = static_cast<int>(std::floor(std::min(a.y, b.y))) - 1;
+    const int x1 = static_cast<int>(std::ceil(std::max(a.x, b.x))) + 1;
+    const int y1 = static_cast<int>(std::ceil(std::max(a.y, b.y))) + 1;
+    return {x0, y0, x1 - x0 + 1, y1 - y0 + 1};
+}
+
+/**
+ * @brief Incremental redraw over a cached static background
+ *
+ * The static part of the scene is drawn once into a background texture, and the last frame
+ * is kept in a second target texture. Every frame the caller lists the screen rectangle of
+ * each moving object it draws; comparing that list with the previous frame's gives the areas
+ * where something appeared or disappeared. Only those are restored from the background and
+ * redrawn, clipped, with the objects that touch them, and the kept frame is then copied to
+ * the output. When the dirty area exceeds FULL_REDRAW_FRACTION of the viewport, the view or
+ * background changed, or the textures were lost, the frame is redrawn completely instead.
+ */
+class FrameCache {
+public:
+    static constexpr double FULL_REDRAW_FRACTION = 0.25;    /*Dirty share of the viewport that redraws everything*/
+
+    FrameCache() = default;
+    FrameCache(const FrameCache&) = delete;
+    FrameCache& operator=(const FrameCache&) = delete;
+
+    ~FrameCache(){
+        invalidate();
+    }
+
+    /**
+     * @brief Drops the textures, the next frame is drawn completely
+     */
+    void invalidate(){
+        for (SDL_Texture** texture : {&background, &frame}){
+            if (*texture){
+                SDL_DestroyTexture(*texture);
+                *texture = nullptr;
+            }
+        }
+        background_valid = false;
+        frame_valid = false;
+        previous.clear();
+    }
+
+    /**
+     * @brief Creates the textures for the output size if needed
+     *
+     * @return [bool] False if the renderer cannot draw to textures, the caller draws directly
+     */
+    bool prepare(SDL_Renderer* renderer, int width, int height){
+        if (!SDL_RenderTargetSupported(renderer)){
+            return false;
+        }
+        if (frame && width == frame_w && height == frame_h){
+            return true;
+        }
+        invalidate();
+        background = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        frame = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        if (!background || !frame){
+            invalidate();
+            return false;
+        }
+        frame_w = width;
+        frame_h = height;
+        return true;
+    }
+
+    /**
+     * @brief Whether the background was drawn for this view, body and orbit
+     *
+     * @param camera: The current view [Camera]
+     * @param body_radius: On-screen radius of the central body (px) [float]
+     * @param orbit_radius: On-screen radius of the drawn orbit (px) [float]
+     */
+    bool backgroundMatches(const Camera& camera, float body_radius, float orbit_radius) const {
+        return background_valid && std::tie(camera.centre_x, camera.centre_y, camera.km_per_px, body_radius, orbit_radius)
+                                    == std::tie(key.centre_x, key.centre_y, key.km_per_px, key_body_radius,
+                                                key_orbit_radius);
+    }
+
+    /**
+     * @brief Directs drawing to the background until endBackground()
+     */
+    void beginBackground(SDL_Renderer* renderer, const Camera& camera, float body_radius, float orbit_radius){
+        SDL_SetRenderTarget(renderer, background);
+        key = camera;
+        key_body_radius = body_radius;
+        key_orbit_radius = orbit_radius;
+        background_valid = true;
+        frame_valid = false;
+    }
+
+    void endBackground(SDL_Renderer* renderer){
+        SDL_SetRenderTarget(renderer, nullptr);
+    }
+
+    /**
+     * @brief Lists a moving object drawn this frame
+     *
+     * @param rect: Every pixel the object touches [SDL_Rect]
+     * @param kind: Distinguishes objects that differ at the same place [uint32_t]
+     */
+    void addObject(const SDL_Rect& rect, uint32_t kind){
+        current.push_back({rect, kind});
+    }
+
+    /**
+     * @brief Works out the dirty region and directs drawing to the kept frame
+     *
+     * Restores the dirty areas from the background; the caller then redraws, for every dirty
+     * rectangle, the objects touching it with the rectangle as clip, or everything if all().
+     *
+     * @return [const DirtyRegion&] Areas to redraw, valid until the next frame
+     */
+    const DirtyRegion& beginFrame(SDL_Renderer* renderer){
+        const SDL_Rect viewport = {0, 0, frame_w, frame_h};
+        dirty.reset(viewport);
+        diffObjects();
+        if (!frame_valid || dirty.area() > FULL_REDRAW_FRACTION * frame_w * frame_h){
+            dirty.markAll();
+        }
+        std::swap(previous, current);
+        current.clear();
+
+        SDL_SetRenderTarget(renderer, frame);
+        if (dirty.all()){
+            SDL_RenderCopy(renderer, background, nullptr, nullptr);
+            ++render_stats.draw_calls;
+        }
+        else {
+            for (const SDL_Rect& rect : dirty){
+                SDL_RenderCopy(renderer, background, &rect, &rect);
+                ++render_stats.draw_calls;
+            }
+        }
+        frame_valid = true;
+        return dirty;
+    }
+
+    /**
+     * @brief Copies the kept frame to the output
+     */
+    void endFrame(SDL_Renderer* renderer){
+        SDL_RenderSetClipRect(renderer, nullptr);
+        SDL_SetRenderTarget(renderer, nullptr);
+        SDL_RenderCopy(renderer, frame, nullptr, nullptr);
+        ++render_stats.draw_calls;
+    }
+
+    /**
+     * @brief Forces the next frame to be drawn completely, keeping the background
+     */
+    void invalidateFrame(){
+        frame_valid = false;
+    }
+
+private:
+    struct Object {
+        SDL_Rect rect;
+        uint32_t kind;
+
+        std::tuple<uint32_t, int, int, int, int> order() const {
+            return {kind, rect.y, rect.x, rect.w, rect.h};
+        }
+    };
+
+    /**
+     * @brief Marks the objects present in only one of the two frames
+     *
+     * Objects that were drawn at the same place in both frames draw the same pixels and are
+     * left alone; both lists are sorted, so matching them is a single merge pass.
+     */
+    void diffObjects(){
+        auto less = [](const Object& a, const Object& b){ return a.order() < b.order(); };
+        std::sort(current.begin(), current.end(), less);
+        size_t i = 0, j = 0;
+        while ((i < previous.size() || j < current.size()) && !dirty.all()){
+            if (j == current.size() || (i < previous.size() && less(previous[i], current[j]))){
+                dirty.add(previous[i++].rect);
+            }
+            else if (i == previous.size() || less(current[j], previous[i])){
+                dirty.add(current[j++].rect);
+            }
+            else {
+                ++i;
+                ++j;
+            }
+        }
+    }
+
+    SDL_Texture* background = nullptr;  /*Static part of the scene*/
+    SDL_Texture* frame = nullptr;       /*Last frame, updated in place*/
+    int frame_w = 0, frame_h = 0;
+    bool background_valid = false;
+    bool frame_valid = false;           /*The kept frame matches the previous object list*/
+    Camera key;                         /*View the background was drawn for*/
+    float key_body_radius = 0;
+    float key_orbit_radius = 0;
+    std::vector<Object> previous;       /*Objects of the last frame, sorted*/
+    std::vector<Object> current;        /*Objects of this frame*/
+    DirtyRegion dirty;
+};
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trace.hpp"
+
+/**
+ * @brief Writes rendered frames to disk as a numbered PPM image sequence
+ *
+ * Frames are ARGB8888 pixels in a small pool of buffers allocated when the capture starts. The
+ * render loop fills a free buffer, either by reading back the renderer output or by having the
+ * software rasterizer copy its frame into it, and queues it; a background thread converts the
+ * queued frames to RGB and writes <prefix>_000000.ppm, <prefix>_000001.ppm, ... before
+ * returning the buffers to the pool. Nothing is allocated per frame. When every buffer is
+ * waiting for the writer, frames are dropped and counted instead of stalling the render loop,
+ * unless the capture was started lossless, as batch runs do.
+ *
+ * The sequence encodes to video with, for example:
+ *   ffmpeg -framerate 60 -i <prefix>_%06d.ppm -pix_fmt yuv420p out.mp4
+ */
+class FrameCapture {
+public:
+    static constexpr size_t POOL_FRAMES = 4;    /*Frame buffers shared by the render loop and the writer*/
+
+    FrameCapture() = default;
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    ~FrameCapture(){
+        stop();
+    }
+
+    bool capturing() const { return writer.joinable(); }
+
+    int width() const { return frame_w; }
+    int height() const { return frame_h; }
+
+    /**
+     * @brief Number of frames dropped because the writer could not keep up or the size changed
+     */
+    uint64_t dropped() const { return dropped_frames.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Number of frames queued so far, which is also the index of the next file
+     */
+    uint64_t frames() const { return queued_frames; }
+
+    /**
+     * @brief Starts a capture
+     *
+     * @param prefix: Path prefix of the image files
+     * @param width: Frame width (px) [int]
+     * @param height: Frame height (px) [int]
+     * @param lossless: Wait for the writer instead of dropping frames [bool]
+     * @return [bool] True if the capture started
+     */
+    bool start(const std::string& prefix, int width, int height, bool lossless = false){
+        stop();
+        if (width <= 0 || height <= 0){
+            return false;
+        }
+        path_prefix = prefix;
+        frame_w = width;
+        frame_h = height;
+        wait_for_writer = lossless;
+        queued_frames = 0;
+        dropped_frames.store(0, std::memory_order_relaxed);
+        write_failed = false;
+
+        const size_t pixels = static_cast<size_t>(width) * height;
+        free_frames.clear();
+        for (Frame& frame : pool){
+            frame.pixels.assign(pixels, 0);
+            free_frames.push_back(&frame);
+        }
+        rgb.resize(pixels * 3);
+        path.resize(prefix.size() + 32);
+        queue_head = 0;
+        queue_size = 0;
+        stopping = false;
+        writer = std::thread([this]{ writerLoop(); });
+        return true;
+    }
+
+    /**
+     * @brief Takes a free buffer of width() * height() pixels, rows packed
+     *
+     * @return [uint32_t*] The buffer to fill and pass to submit(), or nullptr if the frame
+     *         is to be dropped
+     */
+    uint32_t* acquire(){
+        if (!capturing()){
+            return nullptr;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        if (wait_for_writer){
+            returned.wait(lock, [&]{ return !free_frames.empty(); });
+        }
+        if (free_frames.empty()){
+            dropped_frames.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        Frame* frame = free_frames.back();
+        free_frames.pop_back();
+        return frame->pixels.data();
+    }
+
+    /**
+     * @brief Queues a buffer from acquire() for writing
+     *
+     * @param pixels: The filled buffer
+     * @param step: Simulation step shown, recorded in the file [uint64_t]
+     */
+    void submit(uint32_t* pixels, uint64_t step){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            Frame* frame = owner(pixels);
+            frame->step = step;
+            frame->index = queued_frames++;
+            queue[(queue_head + queue_size++) % POOL_FRAMES] = frame;
+        }
+        queued.notify_one();
+    }
+
+    /**
+     * @brief Returns an acquired buffer that will not be submitted
+     */
+    void release(uint32_t* pixels){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            free_frames.push_back(owner(pixels));
+        }
+        returned.notify_one();
+    }
+
+    /**
+     * @brief Reads back the renderer output into a buffer and queues it
+     *
+     * Reading back waits for the renderer to finish the frame; software-rasterized frames are
+     * cheaper to capture through SoftwareRaster::finish().
+     *
+     * @param renderer: A reference to the SDL renderer
+     * @param step: Simulation step shown [uint64_t]
+     * @return [bool] True if the frame was queued
+     */
+    bool captureRenderer(SDL_Renderer* renderer, uint64_t step){
+        if (!capturing()){
+            return false;
+        }
+        TRACE_SCOPE("capture_readback");
+        int output_w = 0, output_h = 0;
+        SDL_GetRendererOutputSize(renderer, &output_w, &output_h);
+        if (output_w != frame_w || output_h != frame_h){
+            dropped_frames.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        uint32_t* pixels = acquire();
+        if (!pixels){
+            return false;
+        }
+        if (SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_ARGB8888, pixels, frame_w * 4) != 0){
+            release(pixels);
+            dropped_frames.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        submit(pixels, step);
+        return true;
+    }
+
+    /**
+     * @brief Writes the queued frames, stops the writer and frees the pool
+     */
+    void stop(){
+        if (!capturing()){
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        queued.notify_one();
+        writer.join();
+        for (Frame& frame : pool){
+            std::vector<uint32_t>().swap(frame.pixels);
+        }
+        std::vector<unsigned char>().swap(rgb);
+        free_frames.clear();
+        if (write_failed){
+            std::cerr << "Captured frames could not be written completely" << std::endl;
+        }
+        if (dropped()){
+            std::cerr << "Frame capture dropped " << dropped() << " frames" << std::endl;
+        }
+    }
+
+private:
+    struct Frame {
+        std::vector<uint32_t> pixels;   /*ARGB8888, rows packed*/
+        uint64_t step = 0;              /*Simulation step shown*/
+        uint64_t index = 0;             /*Number in the file name*/
+    };
+
+    Frame* owner(const uint32_t* pixels){
+        for (Frame& frame : pool){
+            if (frame.pixels.data() == pixels){
+                return &frame;
+            }
+        }
+        return nullptr;
+    }
+
+    void writerLoop(){
+        Tracer::instance().setThreadName("capture");
+        while (true){
+            std::unique_lock<std::mutex> lock(mutex);
+            queued.wait(lock, [&]{ return queue_size > 0 || stopping; });
+            if (queue_size == 0){
+                return;
+            }
+            // Until it is back on the free list, only the writer touches the frame
+            Frame* frame = queue[queue_head];
+            queue_head = (queue_head + 1) % POOL_FRAMES;
+            --queue_size;
+            lock.unlock();
+            writeFrame(*frame);
+            lock.lock();
+            free_frames.push_back(frame);
+            lock.unlock();
+            returned.notify_one();
+        }
+    }
+
+    void writeFrame(const Frame& frame){
+        TRACE_SCOPE("capture_write");
+        const uint32_t* src = frame.pixels.data();
+        for (size_t i = 0, n = frame.pixels.size(); i < n; ++i){
+            rgb[3 * i] = static_cast<unsigned char>(src[i] >> 16);
+            rgb[3 * i + 1] = static_cast<unsigned char>(src[i] >> 8);
+            rgb[3 * i + 2] = static_cast<unsigned char>(src[i]);
+        }
+        snprintf(path.data(), path.size(), "%s_%06llu.ppm", path_prefix.c_str(),
+                 static_cast<unsigned long long>(frame.index));
+        FILE* out = fopen(path.data(), "wb");
+        if (!out){
+            write_failed = true;
+            return;
+        }
+        const bool ok = fprintf(out, "P6\n# orbitsim step %llu\n%d %d\n255\n",
+                                static_cast<unsigned long long>(frame.step), frame_w, frame_h) > 0
+                     && fwrite(rgb.data(), 1, rgb.size(), out) == rgb.size();
+        write_failed = (fclose(out) != 0) || !ok || write_failed;
+    }
+
+    std::string path_prefix;
+    int frame_w = 0, frame_h = 0;
+    bool wait_for_writer = false;       /*Stall instead of dropping when the writer is behind*/
+    uint64_t queued_frames = 0;
+    std::atomic<uint64_t> dropped_frames{0};
+    Frame pool[POOL_FRAMES];
+    std::vector<Frame*> free_frames;    /*Buffers the render loop may fill, capacity POOL_FRAMES*/
+    Frame* queue[POOL_FRAMES];          /*Frames waiting for the writer, oldest at queue_head*/
+    size_t queue_head = 0;
+    size_t queue_size = 0;
+    bool stopping = false;
+    std::vector<unsigned char> rgb;     /*Writer's conversion buffer*/
+    std::vector<char> path;             /*Writer's file name buffer*/
+    bool write_failed = false;          /*Only touched by the writer while it runs*/
+    std::mutex mutex;
+    std::condition_variable queued;     /*Signals the writer*/
+    std::condition_variable returned;   /*Signals the render loop*/
+    std::thread writer;
+};
@@ -0,0 +1,349 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+#include "arena.hpp"
+#include "camera.hpp"
+#include "conjunction.hpp"
+#include "ephemeris.hpp"
+#include "event_scheduler.hpp"
+#include "frame_cache.hpp"
+#include "frame_capture.hpp"
+#include "ipc.hpp"
+#include "lod.hpp"
+#include "orbit.hpp"
+#include "perf_hud.hpp"
+#include "render.hpp"
+#include "scenario.hpp"
+#include "software_raster.hpp"
+#include "trace.hpp"
+#include "trajectory_recorder.hpp"
+#include "worker_pool.hpp"
+
+constexpr uint64_t MAX_TIME_WARP = 1u << 24; /*Largest number of steps simulated per frame*/
+constexpr uint64_t ANALYTIC_WARP_THRESHOLD = 64; /*Time warp above which the auto integrator propagates in closed form*/
+constexpr SDL_Color ORBIT_COLOUR = {0, 96, 0, 255}; /*Orbit of the GUI-controlled satellite*/
+constexpr SDL_Color TRAIL_COLOUR = {0, 160, 0, 255}; /*Trail of the GUI-controlled satellite*/
+
+/**
+ * @brief Report close approaches
+ *
+ * Prints the closest conjunctions found during the frame and how many others there were
+ *
+ * @param report: Conjunctions gathered over the steps of the frame
+ */
+inline void reportConjunctions(const ConjunctionReport& report){
+    for (size_t i = 0; i < report.shown; ++i){
+        const ConjunctionReport::Entry& entry = report.closest[i];
+        std::cout << "Step " << entry.step << ": conjunction alert " << entry.event.id_a << " - "
+                  << entry.event.id_b << " miss distance " << entry.event.miss_distance << '\n';
+    }
+    if (report.count > report.shown){
+        std::cout << report.count - report.shown << " more conjunctions this frame\n";
+    }
+    std::cout.flush();
+}
+
+/**
+ * @brief State and phases of a frame of the interactive simulation
+ *
+ * The main loop polls input, decides whether the frame is drawn and presents it; the work in
+ * between (reading the GUI's parameters, propagating and screening, drawing) lives here, so
+ * the steady-state allocation test runs the same frames as the window.
+ */
+struct FrameLoop {
+    /**
+     * @brief Sets up the frame state for a loaded scenario and adds the GUI-controlled satellite
+     *
+     * @param store: Satellites of the scenario, kept by reference
+     * @param settings: Settings of the scenario, kept by reference
+     */
+    FrameLoop(SatelliteStore& store, const SimConfig& settings)
+        : satellites(store), config(settings),
+          sat_params{settings.gui_speed, settings.gui_altitude},
+          // The GUI-controlled satellite, its speed scaled by the scenario timestep like every other rate
+          sat_idx(store.add(sat_params.altitude, sat_params.orbital_speed * settings.timestep)),
+          analytic_warp_threshold(settings.integrator == Integrator::Step ? MAX_TIME_WARP
+                                  : settings.integrator == Integrator::Analytic ? 0
+                                  : ANALYTIC_WARP_THRESHOLD),
+          camera{0, 0, settings.km_per_px, settings.window_w, settings.window_h},
+          software_raster(settings.software_raster) {
+        for (const SimEvent& event : config.events){
+            scheduler.schedule(event);
+        }
+        lod.disk_limit = config.lod_disk_limit;
+        lod.point_limit = config.lod_point_limit;
+        lod.frame_budget_ms = config.lod_frame_budget_ms;
+    }
+
+    /**
+     * @brief Starts timing a new frame
+     */
+    void beginFrame(){
+        profiler.beginFrame();
+        render_stats = RenderStats{};
+    }
+
+    /**
+     * @brief Reads the parameters sent by the GUI into its satellite
+     *
+     * Only reads when the watcher saw data, if it runs.
+     */
+    void readGui(){
+        TRACE_SCOPE("socket");
+        if (client_socket > 2 && (!ipc_watcher.watching() || ipc_ready)){
+            redraw = getSatelliteData(client_socket, gui_messages, sat_params) || redraw;
+            ipc_ready = false;
+            ipc_watcher.rearm();
+        }
+        satellites.rate[sat_idx] = sat_params.orbital_speed * config.timestep;
+        satellites.altitude[sat_idx] = sat_params.altitude;
+        profiler.lap(FramePhase::Socket);
+    }
+
+    /**
+     * @brief Simulates the steps of the frame
+     *
+     * Updates the position of the satellites and screens for close approaches, stopping at
+     * every scheduled event on the way. Large time warps jump straight to the next stop, which
+     * only screens the last step of the jump.
+     */
+    void simulate(){
+        TRACE_SCOPE("physics");
+        const uint64_t steps = paused ? 0 : time_warp; /*Steps to simulate this frame*/
+        const size_t pending_events = scheduler.size();
+        EventEffects effects; /*What the events applied this frame did*/
+        conjunctions.clear();
+        // Inside a replayed window positions come from the table, except for the
+        // GUI-controlled satellite, which may have been changed since the restore
+        auto replayTo = [&](uint64_t to){
+            if (replay.size() != satellites.size() || satellites.clock < replay.startStep() ||
+                !replay.covers(static_cast<double>(to))){
+                return false;
+            }
+            replay.replayTo(satellites, to);
+            auto [before_x, before_y] = satellites.position(sat_idx, satellites.angle[sat_idx] -
+                                                                     satellites.rate[sat_idx]);
+            auto [sat_x, sat_y] = satellites.position(sat_idx, satellites.angle[sat_idx]);
+            satellites.prev_x[sat_idx] = before_x;
+            satellites.prev_y[sat_idx] = before_y;
+            satellites.x[sat_idx] = sat_x;
+            satellites.y[sat_idx] = sat_y;
+            return true;
+        };
+        scheduler.advance(satellites, satellites.clock + steps, effects, [&](uint64_t to){
+            if (to - satellites.clock > analytic_warp_threshold){
+                if (!replayTo(to)){
+                    satellites.propagateTo(to);
+                }
+                trajectory.record(satellites);
+                conjunctions.add(screener.screen(satellites, config.conjunction_threshold, frame_arena), satellites.clock);
+            }
+            else {
+                while (satellites.clock < to){
+                    if (!replayTo(satellites.clock + 1)){
+                        satellites.step();
+                    }
+                    trajectory.record(satellites);
+                    conjunctions.add(screener.screen(satellites, config.conjunction_threshold, frame_arena), satellites.clock);
+                }
+            }
+        });
+        if (conjunctions.count > 0){
+            reportConjunctions(conjunctions);
+        }
+        if (effects.burns == 1){
+            std::cout << "Step " << effects.last_burn_step << ": burn of satellite " << effects.last_burn
+                      << std::endl;
+        }
+        else if (effects.burns > 1){
+            std::cout << "Steps up to " << effects.last_burn_step << ": " << effects.burns << " burns" << std::endl;
+        }
+        if (effects.pause){
+            paused = true;
+            std::cout << "Step " << satellites.clock << ": paused by the scenario" << std::endl;
+        }
+        if (effects.time_warp){
+            time_warp = std::min(effects.time_warp, MAX_TIME_WARP);
+            std::cout << "Time warp: " << time_warp << "x" << std::endl;
+        }
+        if (steps > 0){
+            trail.push(satellites.x[sat_idx], satellites.y[sat_idx]);
+        }
+        redraw = redraw || steps > 0 || scheduler.size() != pending_events;
+        profiler.lap(FramePhase::Physics);
+    }
+
+    /**
+     * @brief Draws the frame, overlay included, without presenting it
+     *
+     * @param renderer: Renderer of the window
+     */
+    void render(SDL_Renderer* renderer){
+        TRACE_SCOPE("render");
+        redraw = false;
+        const SDL_Rect viewport = {0, 0, camera.viewport_w, camera.viewport_h};
+        auto [earth_x, earth_y] = camera.worldToScreen(0, 0);
+        const float earth_radius = camera.toPixels(satellites.body_radius);
+        const float orbit_radius = camera.toPixels(satellites.body_radius + satellites.altitude[sat_idx]);
+        // The SDL renderer only redraws what moved, over the cached Earth and orbit
+        const bool incremental = !software_raster &&
+                                 frame_cache.prepare(renderer, camera.viewport_w, camera.viewport_h);
+
+        // Static background: black, Earth (just a blue blob for now, please don't lose your
+        // shit over this uwu) and the orbit of the GUI-controlled satellite
+        if (software_raster){
+            raster.begin(camera.viewport_w, camera.viewport_h, {0,0,0,255});
+            if (camera.isVisible(earth_x, earth_y, earth_radius)){
+                raster.disk(earth_x, earth_y, earth_radius, {0,0,255,255});
+            }
+            raster.ring(earth_x, earth_y, orbit_radius, dpi_scale, ORBIT_COLOUR);
+        }
+        else if (!incremental || !frame_cache.backgroundMatches(camera, earth_radius, orbit_radius)){
+            if (incremental){
+                frame_cache.beginBackground(renderer, camera, earth_radius, orbit_radius);
+            }
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+            SDL_RenderClear(renderer);
+            if (camera.isVisible(earth_x, earth_y, earth_radius)){
+                earth_sprite.draw(renderer, earth_x, earth_y, earth_radius, {0,0,255,255}, viewport);
+            }
+            drawRing(renderer, earth_x, earth_y, orbit_radius, ORBIT_COLOUR, frame_arena);
+            if (incremental){
+                frame_cache.endBackground(renderer);
+            }
+        }
+
+        // Trail of the GUI-controlled satellite
+        SDL_FPoint* trail_points = frame_arena.alloc<SDL_FPoint>(trail.size()); /*Trail in screen coordinates*/
+        for (size_t i = 0; i < trail.size(); ++i){
+            auto [screen_x, screen_y] = camera.worldToScreen(trail[i].x, trail[i].y);
+            trail_points[i] = {screen_x, screen_y};
+        }
+
+        // Cull satellites outside the viewport before any rasterization work
+        const float satellite_radius = SATELLITE_RADIUS_PX * dpi_scale;
+        ArenaArray<SDL_FPoint> visible(frame_arena, satellites.size()); /*Screen positions of the satellites inside the viewport*/
+        for (size_t i = 0; i < satellites.size(); ++i){
+            auto [screen_x, screen_y] = camera.worldToScreen(satellites.x[i], satellites.y[i]);
+            if (camera.isVisible(screen_x, screen_y, satellite_radius)){
+                visible.push_back({screen_x, screen_y});
+            }
+        }
+        const Uint64 draw_start = SDL_GetPerformanceCounter();
+        const LodMode lod_mode = lod.select(visible.size(), last_draw_ms);
+        auto drawTrail = [&](){
+            SDL_SetRenderDrawColor(renderer, TRAIL_COLOUR.r, TRAIL_COLOUR.g, TRAIL_COLOUR.b, TRAIL_COLOUR.a);
+            SDL_RenderDrawLinesF(renderer, trail_points, static_cast<int>(trail.size()));
+            ++render_stats.draw_calls;
+        };
+        if (software_raster){
+            raster.lines(trail_points, trail.size(), 2 * dpi_scale, TRAIL_COLOUR);
+            drawSatellitesSoftware(raster, visible, lod_mode, satellite_radius, density, viewport, {0,255,0,255});
+            // The CPU rasterizer does all of its work here, Earth included, and hands the
+            // frame to the capture while it is still in memory
+            uint32_t* capture_pixels = capture.acquire();
+            if (raster.finish(renderer, workers, capture_pixels)){
+                if (capture_pixels){
+                    capture.submit(capture_pixels, satellites.clock);
+                }
+            }
+            else {
+                if (capture_pixels){
+                    capture.release(capture_pixels);
+                }
+                std::cerr << "Software rasterizer unavailable, using the SDL renderer" << std::endl;
+                software_raster = false;
+            }
+        }
+        else if (!incremental){
+            drawTrail();
+            drawSatellites(renderer, visible, lod_mode, satellite_sprite, satellite_radius, density, viewport,
+                           {0,255,0,255});
+        }
+        else {
+            // List what moves: trail segments, and satellite disks. Points and density
+            // cells are too many and too small to track, so those frames are redrawn whole
+            for (size_t i = 1; i < trail.size(); ++i){
+                frame_cache.addObject(segmentBounds(trail_points[i - 1], trail_points[i]), 1);
+            }
+            if (lod_mode == LodMode::Disk){
+                for (const SDL_FPoint& sat : visible){
+                    frame_cache.addObject(DiskSprite::footprint(sat.x, sat.y, satellite_radius), 0);
+                }
+            }
+            else {
+                frame_cache.invalidateFrame();
+            }
+            const DirtyRegion& dirty = frame_cache.beginFrame(renderer);
+            if (dirty.all()){
+                drawTrail();
+                drawSatellites(renderer, visible, lod_mode, satellite_sprite, satellite_radius, density,
+                               viewport, {0,255,0,255});
+            }
+            else {
+                for (const SDL_Rect& rect : dirty){
+                    SDL_RenderSetClipRect(renderer, &rect);
+                    drawTrail();
+                    for (const SDL_FPoint& sat : visible){
+                        const SDL_Rect bounds = DiskSprite::footprint(sat.x, sat.y, satellite_radius);
+                        if (SDL_HasIntersection(&bounds, &rect)){
+                            satellite_sprite.draw(renderer, sat.x, sat.y, satellite_radius, {0,255,0,255},
+                                                  viewport);
+                        }
+                    }
+                }
+            }
+            frame_cache.endFrame(renderer);
+        }
+        last_draw_ms = 1000.0 * (SDL_GetPerformanceCounter() - draw_start) / SDL_GetPerformanceFrequency();
+
+        // Captured frames leave out the overlay
+        if (!software_raster){
+            capture.captureRenderer(renderer, satellites.clock);
+        }
+
+        hud.draw(renderer, profiler, {satellites.size(), visible.size(), render_stats.draw_calls,
+                                      lodModeName(lod_mode), frame_arena.highWater()});
+        profiler.lap(FramePhase::Render);
+    }
+
+    SatelliteStore& satellites; /*State of all simulated satellites*/
+    const SimConfig& config; /*Settings of the scenario*/
+    SatelliteParams sat_params; /*Parameters of the GUI-controlled satellite*/
+    const size_t sat_idx; /*Index of the GUI-controlled satellite*/
+    const uint64_t analytic_warp_threshold; /*Time warp above which orbits are propagated in closed form*/
+    ConjunctionScreener screener; /*Close-approach screening between satellites*/
+    ConjunctionReport conjunctions; /*Close approaches found during the frame*/
+    EventScheduler scheduler; /*Events the scenario scheduled*/
+    EphemerisCache replay; /*Window rewound by restoring the snapshot, replayed instead of propagated*/
+    TrajectoryRecorder trajectory; /*Streams trajectories to disk, toggled with F6*/
+    uint64_t time_warp = 1; /*Steps simulated per frame*/
+    bool paused = false; /*Whether the simulation is stopped, toggled with space*/
+    bool redraw = true; /*Whether anything changed since the last present*/
+    int client_socket = -1; /*Socket the GUI sends its parameters on*/
+    MessageBuffer gui_messages; /*Partial message received from the GUI*/
+    IpcWatcher ipc_watcher; /*Wakes the loop when the GUI sends data*/
+    bool ipc_ready = false; /*Whether the GUI socket has data waiting*/
+    Trail trail; /*Recent positions of the GUI-controlled satellite, one per frame*/
+    Camera camera; /*Maps world coordinates (km) to the renderer output*/
+    float dpi_scale = 1.0f; /*Output pixels per window coordinate, above 1 on HiDPI displays*/
+    DiskSprite earth_sprite; /*Cached Earth disk*/
+    DiskSprite satellite_sprite; /*Cached satellite disk*/
+    FrameCache frame_cache; /*Cached background and last frame for incremental redraws*/
+    bool software_raster; /*Whether the CPU rasterizer draws the scene, toggled with F7*/
+    SoftwareRaster raster; /*CPU rasterizer*/
+    WorkerPool workers; /*Threads rasterizing the tiles*/
+    LodPolicy lod; /*Picks how satellites are drawn*/
+    DensityGrid density; /*Satellite density for the most aggregated level of detail*/
+    double last_draw_ms = 0; /*Time spent drawing satellites in the last frame*/
+    FrameProfiler profiler; /*Per-phase frame timings*/
+    PerfHud hud; /*Performance overlay, toggled with F3*/
+    FrameCapture capture; /*Writes drawn frames to disk, toggled with F8*/
+    FrameArena& frame_arena = threadArena(); /*Scratch data of the loop's thread, released every frame*/
+};
@@ -0,0 +1,285 @@
+#pragma once
+
+#include <unistd.h>
+#include <charconv>
+#include <iostream>
+#include <string_view>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <sys/poll.h>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "trace.hpp"
+
+/**
+ * @brief Create a Socket object 
+ * 
+ * Creates a client socket object and establishes a connection request to the server
+ * 
+ * @param socket_path: The path to the socket
+ * @return [int] The client socket descriptor
+ */
+inline int createSocket(const char* socket_path){
+    // Create a Unix domain socket
+    int client_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (client_socket == -1){
+        std::cerr << "Error creating socket" << std::endl;
+        return 1;
+    }
+
+    // Set up socket address
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socket_path, sizeof(address.sun_path)-1);
+
+    // connect to the server
+    bool connected = false;
+
+    int flags = fcntl(client_socket, F_GETFL, 0);
+    if (fcntl(client_socket, F_SETFL, flags | O_NONBLOCK) == -1)
+    {
+        perror("fcntl");
+        return 1;
+    }
+
+    // counter for connection patience
+    int fallback = 0;
+    while (!connected)
+    {
+        printf("Attempting to connect to server... ");
+        fflush(stdout);
+        if (connect(client_socket, (struct sockaddr*)&address, sizeof(address)) == -1){
+            if (errno == ENOENT || errno == ECONNREFUSED) {
+                if (fallback > 2){
+                    return 0;
+                }
+                std::cerr << "Retrying connection";
+                sleep(1);
+                ++fallback;
+            }
+            else {
+                std::cerr << "Error connecting to socket: " << strerror(errno) << std::endl;
+                close(client_socket);
+                return 1;
+            }
+
+        }
+        else {
+            printf("Connection to server established");
+            fflush(stdout);
+            connected = true;
+        }
+    }     
+
+    return client_socket;
+}
+
+/**
+ * @brief Satellite parameters sent by the GUI
+ */
+struct SatelliteParams {
+    int orbital_speed = 2;  /*Orbital speed (degrees per step)*/
+    int altitude = 10;      /*Altitude (km)*/
+};
+
+/**
+ * @brief Bytes received from the GUI that do not form a whole message yet
+ */
+struct MessageBuffer {
+    char data[1024];
+    size_t used = 0;
+};
+
+/**
+ * @brief Applies one "key=value" message to the satellite parameters
+ *
+ * @param line: The message without its newline
+ * @param params: Satellite parameters to update
+ * @return [bool] True if a parameter changed
+ */
+inline bool applyParamMessage(std::string_view line, SatelliteParams& params){
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ')){
+        line.remove_suffix(1);
+    }
+    const size_t equals = line.find('=');
+    if (line.empty() || equals == std::string_view::npos){
+        std::cerr << "Ignoring malformed GUI message \"" << line << "\"" << std::endl;
+        return false;
+    }
+    const std::string_view key = line.substr(0, equals);
+    const std::string_view text = line.substr(equals + 1);
+    int* target = key == "speed" ? &params.orbital_speed : key == "altitude" ? &params.altitude : nullptr;
+    int value = 0;
+    const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (!target || ec != std::errc() || end != text.data() + text.size()){
+        std::cerr << "Ignoring malformed GUI message \"" << line << "\"" << std::endl;
+        return false;
+    }
+    const bool changed = *target != value;
+    *target = value;
+    return changed;
+}
+
+/**
+ * @brief Get satellite data
+ * 
+ * Receives satellite parameters from Python as newline-terminated "key=value" messages
+ * (speed in degrees per step, altitude in km) and writes them into the caller's parameters,
+ * which are left untouched when nothing arrives. The socket is drained without waiting, so a
+ * burst of slider updates is coalesced: only the latest value of each parameter survives to
+ * the next step. A message split across reads is kept in `pending` until its newline arrives.
+ * Nothing is allocated, so the call can sit in the steady-state frame loop
+ * 
+ * @param socket_desc: Integer descriptor of the client socket
+ * @param pending: Partial message carried over between calls
+ * @param params: Satellite parameters to update
+ * @return [bool] True if a parameter changed
+ */
+inline bool getSatelliteData(int socket_desc, MessageBuffer& pending, SatelliteParams& params){
+    TRACE_SCOPE("getSatelliteData");
+    bool changed = false;
+    while (true){
+        if (pending.used == sizeof(pending.data)){
+            std::cerr << "Discarding an overlong GUI message" << std::endl;
+            pending.used = 0;
+        }
+        ssize_t bytes_received;
+        {
+            TRACE_SCOPE("recv");
+            bytes_received = recv(socket_desc, pending.data + pending.used, sizeof(pending.data) - pending.used,
+                                  MSG_DONTWAIT);
+        }
+        if (bytes_received == -1){
+            if (errno != EWOULDBLOCK && errno != EAGAIN && errno != EINTR){
+                std::cerr << "Error receiving GUI data: " << strerror(errno) << std::endl;
+            }
+            if (errno != EINTR){
+                break;
+            }
+            continue;
+        }
+        if (bytes_received == 0){
+            // Sender closed the connection
+            break;
+        }
+        pending.used += static_cast<size_t>(bytes_received);
+
+        // Apply every complete message, later ones overriding earlier ones
+        const char* start = pending.data;
+        const char* end = pending.data + pending.used;
+        while (const char* newline = static_cast<const char*>(memchr(start, '\n', end - start))){
+            changed = applyParamMessage(std::string_view(start, newline - start), params) || changed;
+            start = newline + 1;
+        }
+        pending.used = static_cast<size_t>(end - start);
+        memmove(pending.data, start, pending.used);
+    }
+    return changed;
+}
+
+/**
+ * @brief Wakes the caller when the GUI socket becomes readable
+ *
+ * A background thread sleeps in poll() on the socket and calls `on_ready` once data (or a
+ * hang-up) is pending, then ignores the socket until rearm() is called after the data was
+ * read, so a level-triggered poll cannot spin. This lets the frame loop block on its own
+ * event queue instead of polling the socket every frame. A hang-up ends the watch.
+ */
+class IpcWatcher {
+public:
+    IpcWatcher() = default;
+    IpcWatcher(const IpcWatcher&) = delete;
+    IpcWatcher& operator=(const IpcWatcher&) = delete;
+
+    ~IpcWatcher(){
+        stop();
+    }
+
+    /**
+     * @brief Starts watching a socket
+     *
+     * @param socket_desc: Integer descriptor of the client socket
+     * @param on_ready: Called from the watcher thread when the socket is readable
+     * @return [bool] True if the watcher thread started
+     */
+    bool start(int socket_desc, std::function<void()> on_ready){
+        stop();
+        if (pipe(wake_pipe) == -1){
+            perror("pipe");
+            return false;
+        }
+        notify = std::move(on_ready);
+        stopping.store(false, std::memory_order_relaxed);
+        watcher = std::thread([this, socket_desc]{ watchLoop(socket_desc); });
+        return true;
+    }
+
+    bool watching() const { return watcher.joinable(); }
+
+    /**
+     * @brief Resumes watching once the pending data has been read
+     */
+    void rearm(){
+        if (watching()){
+            const char byte = 'r';
+            (void)!write(wake_pipe[1], &byte, 1);
+        }
+    }
+
+    void stop(){
+        if (!watching()){
+            return;
+        }
+        stopping.store(true, std::memory_order_relaxed);
+        rearm();
+        watcher.join();
+        close(wake_pipe[0]);
+        close(wake_pipe[1]);
+    }
+
+private:
+    void watchLoop(int socket_desc){
+        Tracer::instance().setThreadName("ipc watcher");
+        bool armed = true;
+        bool open = true;
+        while (true){
+            struct pollfd fds[2];
+            fds[0] = {wake_pipe[0], POLLIN, 0};
+            fds[1] = {socket_desc, POLLIN, 0};
+            if (poll(fds, armed && open ? 2 : 1, -1) == -1){
+                if (errno == EINTR){
+                    continue;
+                }
+                perror("poll");
+                return;
+            }
+            if (fds[0].revents & POLLIN){
+                char bytes[64];
+                (void)!read(wake_pipe[0], bytes, sizeof(bytes));
+                if (stopping.load(std::memory_order_relaxed)){
+                    return;
+                }
+                armed = true;
+            }
+            else if (armed && open && fds[1].revents){
+                // Readable, closed or failed: the reader finds out which
+                open = !(fds[1].revents & (POLLHUP | POLLERR | POLLNVAL));
+                armed = false;
+                notify();
+            }
+        }
+    }
+
+    std::thread watcher;
+    int wake_pipe[2] = {-1, -1};            /*Rearm and stop requests to the watcher thread*/
+    std::function<void()> notify;
+    std::atomic<bool> stopping{false};
+};
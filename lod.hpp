@@ -0,0 +1,172 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief How satellites are drawn
+ */
+enum class LodMode {
+    Disk,       /*Filled disk per satellite*/
+    Point,      /*Single pixel per satellite, drawn in one batch*/
+    Density     /*Aggregate density of satellites per screen cell*/
+};
+
+inline const char* lodModeName(LodMode mode){
+    static const char* names[] = {"DISK", "POINT", "DENSITY"};
+    return names[static_cast<int>(mode)];
+}
+
+/**
+ * @brief Level-of-detail selection
+ *
+ * Picks the satellite drawing mode from the number of visible satellites, then corrects it
+ * with the time the last frame spent drawing: a frame over budget drops one level of detail
+ * and remembers the visible count it happened at. A frame comfortably under budget (half of
+ * it) goes back up one level once the visible count is well below the remembered one, which
+ * keeps the mode from flickering between a slow level and a fast one.
+ */
+struct LodPolicy {
+    size_t disk_limit = 2000;       /*Most visible satellites drawn as disks*/
+    size_t point_limit = 50000;     /*Most visible satellites drawn as points*/
+    double frame_budget_ms = 8.0;   /*Time the satellite pass may take per frame (ms)*/
+
+    LodMode mode = LodMode::Disk;
+    size_t over_budget_at[3] = {0, 0, 0}; /*Visible count at which each mode went over budget*/
+
+    /**
+     * @brief Selects the drawing mode for this frame
+     *
+     * @param visible: Number of satellites inside the viewport [size_t]
+     * @param last_draw_ms: Time spent drawing satellites in the last frame (ms) [double]
+     * @return [LodMode] The drawing mode
+     */
+    LodMode select(size_t visible, double last_draw_ms){
+        const LodMode by_count = visible <= disk_limit ? LodMode::Disk
+                               : visible <= point_limit ? LodMode::Point
+                               : LodMode::Density;
+        if (last_draw_ms > frame_budget_ms && mode != LodMode::Density){
+            over_budget_at[static_cast<int>(mode)] = visible;
+            mode = static_cast<LodMode>(static_cast<int>(mode) + 1);
+        }
+        else if (last_draw_ms < 0.5 * frame_budget_ms && mode > by_count){
+            const int finer = static_cast<int>(mode) - 1;
+            if (over_budget_at[finer] == 0 || visible < over_budget_at[finer] * 3 / 4){
+                over_budget_at[finer] = 0;
+                mode = static_cast<LodMode>(finer);
+            }
+        }
+        // Never show more detail than the visible count allows
+        mode = std::max(mode, by_count);
+        return mode;
+    }
+};
+
+/**
+ * @brief Screen-space density of satellites
+ *
+ * Bins the visible satellites into square cells and turns the counts into one rectangle per
+ * occupied cell, grouped by brightness level so that each level is a single batched fill.
+ * Brightness follows the logarithm of the count, which keeps both sparse and crowded regions
+ * readable.
+ */
+class DensityGrid {
+public:
+    static constexpr int LEVELS = 8;
+
+    /**
+     * @brief Rectangles of one brightness level, a view into the grid's buffer
+     */
+    struct Level {
+        const SDL_Rect* rects = nullptr;
+        size_t count = 0;
+
+        const SDL_Rect* data() const { return rects; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+    };
+
+    explicit DensityGrid(int cell_px=4) : cell(cell_px) {}
+
+    /**
+     * @brief Clears the grid for a viewport
+     *
+     * @param width: Viewport width (px) [int]
+     * @param height: Viewport height (px) [int]
+     */
+    void reset(int width, int height){
+        cols = (width + cell - 1) / cell;
+        rows = (height + cell - 1) / cell;
+        const size_t cells = static_cast<size_t>(cols) * rows;
+        counts.assign(cells, 0);
+        // Every cell lands in at most one level, so one rectangle per cell always suffices
+        if (rects.size() < cells){
+            rects.resize(cells);
+        }
+        max_count = 0;
+    }
+
+    /**
+     * @brief Adds a satellite at a screen position inside the viewport
+     */
+    void add(float screen_x, float screen_y){
+        const int cx = std::clamp(static_cast<int>(screen_x) / cell, 0, cols - 1);
+        const int cy = std::clamp(static_cast<int>(screen_y) / cell, 0, rows - 1);
+        const uint32_t count = ++counts[static_cast<size_t>(cy) * cols + cx];
+        max_count = std::max(max_count, count);
+    }
+
+    /**
+     * @brief Builds the rectangles of the occupied cells, one list per brightness level
+     *
+     * The rectangles are sorted by level into a buffer sized by reset(), so building never
+     * allocates; the counts are overwritten with the levels on the way.
+     *
+     * @return [std::array] Rectangles for each level, brightest last, valid until the next reset
+     */
+    const std::array<Level, LEVELS>& build(){
+        size_t level_size[LEVELS] = {};
+        if (max_count > 0){
+            const float inv_log_max = 1.0f / std::log1p(static_cast<float>(max_count));
+            for (uint32_t& count : counts){
+                if (count == 0){
+                    continue;
+                }
+                const float brightness = std::log1p(static_cast<float>(count)) * inv_log_max;
+                const int level = std::min(static_cast<int>(brightness * LEVELS), LEVELS - 1);
+                ++level_size[level];
+                count = static_cast<uint32_t>(level) + 1;
+            }
+        }
+        size_t fill[LEVELS];
+        size_t start = 0;
+        for (int level = 0; level < LEVELS; ++level){
+            fill[level] = start;
+            levels[level] = {rects.data() + start, level_size[level]};
+            start += level_size[level];
+        }
+        for (int cy = 0; cy < rows && max_count > 0; ++cy){
+            for (int cx = 0; cx < cols; ++cx){
+                const uint32_t level = counts[static_cast<size_t>(cy) * cols + cx];
+                if (level != 0){
+                    rects[fill[level - 1]++] = {cx * cell, cy * cell, cell, cell};
+                }
+            }
+        }
+        return levels;
+    }
+
+private:
+    int cell;
+    int cols = 0, rows = 0;
+    uint32_t max_count = 0;
+    std::vector<uint32_t> counts;   /*Satellites per cell, then level + 1 once built*/
+    std::vector<SDL_Rect> rects;    /*Rectangles of the occupied cells, grouped by level*/
+    std::array<Level, LEVELS> levels;
+};
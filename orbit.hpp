@@ -0,0 +1,342 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+constexpr double EARTH_RADIUS_KM = 6371.0; /*Mean radius of the Earth (km)*/
+
+/**
+ * @brief Precision policies of the orbit math and state
+ *
+ * The satellite store and the functions below are templates on a policy whose Real type is
+ * used for the stored orbital elements and every computation on them, so each policy gets a
+ * fully specialised instantiation without conversions in the loops. Double is the default
+ * and keeps the elements and the phase accurate over long runs; float halves the memory
+ * traffic and suits runs that only feed the renderer.
+ *
+ * Positions are computed in Real but returned and stored as float under both policies, since
+ * the screener, the renderer and the snapshot and shared-memory layouts all take floats. A
+ * stored position therefore resolves about half a metre in LEO and about 4 m at GEO distance,
+ * whatever the policy; double only keeps the error from growing on top of that.
+ */
+struct DoublePrecision {
+    using Real = double;
+    static constexpr double KEPLER_TOLERANCE = 1e-12;   /*Newton step small enough to stop (radians)*/
+    static constexpr const char* NAME = "double";
+};
+
+struct FloatPrecision {
+    using Real = float;
+    static constexpr float KEPLER_TOLERANCE = 1e-6f;    /*Newton step small enough to stop (radians)*/
+    static constexpr const char* NAME = "float";
+};
+
+/**
+ * @brief Calculates the satellite's X and Y coordinates
+ *
+ * Receives the angle of the satellite and calculates its X- and Y-coordinates in world
+ * space (km, origin at the centre of the Earth)
+ *
+ * @param angle: Satellite angle (degrees) [Real]
+ * @param altitude: Altitude above the surface of the Earth (km) [Real]
+ * @param body_radius: Radius of the central body (km) [Real]
+ * @return [std::tuple] The X- and Y-coordinates of the satellite respectively (km)
+*/
+template <typename P = DoublePrecision>
+std::tuple<float, float> calculate_sat_coordinates(typename P::Real angle, typename P::Real altitude=100,
+                                                   typename P::Real body_radius=EARTH_RADIUS_KM){
+    using Real = typename P::Real;
+    const Real radius = body_radius + altitude;
+    const Real radians = static_cast<Real>(M_PI / 180.0) * angle;
+    float sat_x = radius * std::cos(radians);
+    float sat_y = radius * std::sin(radians);
+    return {sat_x, sat_y};
+}
+
+/**
+ * @brief Solves Kepler's equation for the eccentric anomaly
+ *
+ * Newton iteration on E - e sin(E) = M, converging in a handful of iterations for
+ * the closed orbits we simulate (e < 1)
+ *
+ * @param mean_anomaly: Mean anomaly (radians) [Real]
+ * @param eccentricity: Orbit eccentricity [Real]
+ * @return [Real] The eccentric anomaly (radians)
+ */
+template <typename P = DoublePrecision>
+typename P::Real solve_kepler(typename P::Real mean_anomaly, typename P::Real eccentricity){
+    using Real = typename P::Real;
+    Real ecc_anomaly = eccentricity < Real(0.8) ? mean_anomaly : static_cast<Real>(M_PI);
+    for (int iter = 0; iter < 16; ++iter){
+        const Real delta = (ecc_anomaly - eccentricity * std::sin(ecc_anomaly) - mean_anomaly)
+                         / (Real(1) - eccentricity * std::cos(ecc_anomaly));
+        ecc_anomaly -= delta;
+        if (std::fabs(delta) < P::KEPLER_TOLERANCE){
+            break;
+        }
+    }
+    return ecc_anomaly;
+}
+
+/**
+ * @brief Calculates the X and Y coordinates of a satellite on a Keplerian orbit
+ *
+ * @param mean_anomaly: Mean anomaly (degrees) [Real]
+ * @param semi_major: Semi-major axis (km) [Real]
+ * @param eccentricity: Orbit eccentricity [Real]
+ * @param periapsis: Argument of periapsis (degrees) [Real]
+ * @return [std::tuple] The X- and Y-coordinates of the satellite respectively (km)
+ */
+template <typename P = DoublePrecision>
+std::tuple<float, float> calculate_kepler_coordinates(typename P::Real mean_anomaly, typename P::Real semi_major,
+                                                      typename P::Real eccentricity, typename P::Real periapsis){
+    using Real = typename P::Real;
+    constexpr Real deg_to_rad = static_cast<Real>(M_PI / 180.0);
+    const Real ecc_anomaly = solve_kepler<P>(deg_to_rad * mean_anomaly, eccentricity);
+    // Position in the orbital plane with the focus at the origin, rotated onto periapsis
+    const Real px = semi_major * (std::cos(ecc_anomaly) - eccentricity);
+    const Real py = semi_major * std::sqrt(Real(1) - eccentricity * eccentricity) * std::sin(ecc_anomaly);
+    const Real cos_w = std::cos(deg_to_rad * periapsis);
+    const Real sin_w = std::sin(deg_to_rad * periapsis);
+    float sat_x = px * cos_w - py * sin_w;
+    float sat_y = px * sin_w + py * cos_w;
+    return {sat_x, sat_y};
+}
+
+/**
+ * @brief How a satellite's orbit is propagated
+ */
+enum class Propagator : uint8_t {
+    Circular,   /*Eccentricity 0, the position follows from the angle alone*/
+    Kepler,     /*Fixed ellipse, Kepler's equation is solved at every evaluation*/
+    Perturbed   /*Ellipse whose periapsis precesses at a constant rate, as under J2*/
+};
+constexpr size_t PROPAGATORS = 3;
+
+/**
+ * @brief Satellite state store
+ *
+ * Keeps the state of every simulated satellite as a structure of arrays so that per-step
+ * passes (propagation, screening, drawing) walk contiguous memory. The position of the
+ * previous step is kept alongside the current one so that consumers can reason about the
+ * motion within a step.
+ *
+ * Orbits are circular (eccentricity 0), Keplerian, or Keplerian with a precessing periapsis.
+ * The angle is the mean anomaly and the periapsis advances by a fixed amount per step, both
+ * linear in time, so any future step can be reached in closed form. Positions are in world
+ * space (km, origin at the centre of the Earth). The orbital elements are kept in the Real
+ * type of the precision policy P; use the SatelliteStore and FloatSatelliteStore aliases below.
+ *
+ * Propagation walks one group of satellites per Propagator, each with a kernel instantiated
+ * for that propagator, so the inner loops carry no per-satellite choice of model. Groups list
+ * store indices in ascending order and are rebuilt lazily after invalidateGroups(); the
+ * indices themselves never move, so callers keep addressing satellites by index.
+ */
+template <typename P>
+struct BasicSatelliteStore {
+    using Real = typename P::Real;
+
+    uint64_t clock = 0;             /*Number of steps simulated*/
+    Real body_radius = EARTH_RADIUS_KM; /*Radius of the central body the altitudes refer to (km)*/
+    std::vector<uint32_t> id;       /*Stable satellite identifier*/
+    std::vector<Real> angle;        /*Mean anomaly (degrees)*/
+    std::vector<Real> rate;         /*Mean anomaly advanced per step (degrees)*/
+    std::vector<Real> altitude;     /*Altitude (km), mean altitude for Keplerian orbits*/
+    std::vector<Real> eccentricity; /*Orbit eccentricity, 0 for circular orbits*/
+    std::vector<Real> periapsis;    /*Argument of periapsis (degrees)*/
+    std::vector<Real> precession;   /*Argument of periapsis advanced per step (degrees), 0 for a fixed ellipse*/
+    std::vector<float> x, y;        /*Position at the current step, float under every policy*/
+    std::vector<float> prev_x, prev_y; /*Position at the previous step*/
+
+    size_t size() const { return id.size(); }
+
+    /**
+     * @brief Adds a satellite to the store
+     *
+     * @param sat_altitude: Altitude above the surface, mean altitude for Keplerian orbits (km) [double]
+     * @param sat_rate: Angular displacement per step (degrees) [double]
+     * @param sat_angle: Initial mean anomaly (degrees) [double]
+     * @param sat_eccentricity: Orbit eccentricity [double]
+     * @param sat_periapsis: Argument of periapsis (degrees) [double]
+     * @param sat_precession: Periapsis advance per step (degrees) [double]
+     * @return [size_t] Index of the new satellite
+     */
+    size_t add(double sat_altitude, double sat_rate, double sat_angle=0,
+               double sat_eccentricity=0, double sat_periapsis=0, double sat_precession=0){
+        const size_t idx = size();
+        id.push_back(static_cast<uint32_t>(idx));
+        angle.push_back(static_cast<Real>(sat_angle));
+        rate.push_back(static_cast<Real>(sat_rate));
+        altitude.push_back(static_cast<Real>(sat_altitude));
+        eccentricity.push_back(static_cast<Real>(sat_eccentricity));
+        periapsis.push_back(static_cast<Real>(sat_periapsis));
+        precession.push_back(static_cast<Real>(sat_precession));
+        auto [sat_x, sat_y] = position(idx, angle[idx]);
+        x.push_back(sat_x);
+        y.push_back(sat_y);
+        prev_x.push_back(sat_x);
+        prev_y.push_back(sat_y);
+        // The new index is the largest, appending keeps its group sorted
+        if (groups_valid){
+            groups[static_cast<size_t>(propagator(idx))].push_back(static_cast<uint32_t>(idx));
+        }
+        // Every group keeps room for every satellite, so burns moving satellites between
+        // propagators regroup without allocating
+        for (auto& group : groups){
+            if (group.capacity() < id.capacity()){
+                group.reserve(id.capacity());
+            }
+        }
+        return idx;
+    }
+
+    /**
+     * @brief Propagator a satellite's elements call for
+     */
+    Propagator propagator(size_t i) const {
+        if (eccentricity[i] == 0){
+            return Propagator::Circular;
+        }
+        return precession[i] == 0 ? Propagator::Kepler : Propagator::Perturbed;
+    }
+
+    /**
+     * @brief Regroups the satellites before the next propagation
+     *
+     * Must be called after changing the eccentricity or precession of satellites in place, or
+     * after replacing the columns wholesale, since either can change their propagator.
+     */
+    void invalidateGroups(){
+        groups_valid = false;
+    }
+
+    /**
+     * @brief Position of a satellite at a given mean anomaly
+     */
+    std::tuple<float, float> position(size_t i, Real mean_anomaly) const {
+        return position(i, mean_anomaly, periapsis[i]);
+    }
+
+    /**
+     * @brief Position of a satellite at a given mean anomaly and argument of periapsis
+     */
+    std::tuple<float, float> position(size_t i, Real mean_anomaly, Real arg_periapsis) const {
+        if (eccentricity[i] == 0){
+            return calculate_sat_coordinates<P>(mean_anomaly, altitude[i], body_radius);
+        }
+        return calculate_kepler_coordinates<P>(mean_anomaly, body_radius + altitude[i],
+                                               eccentricity[i], arg_periapsis);
+    }
+
+    /**
+     * @brief Advances every satellite by one step
+     */
+    void step(){
+        updateGroups();
+        stepGroup<Propagator::Circular>();
+        stepGroup<Propagator::Kepler>();
+        stepGroup<Propagator::Perturbed>();
+        ++clock;
+    }
+
+    /**
+     * @brief Jumps every satellite directly to a future step
+     *
+     * Evaluates the orbits in closed form, so the cost is independent of how many steps are
+     * skipped. The previous position is set to the step just before the target so that the
+     * last step can still be screened like a regular one. The phase advanced over the jump is
+     * reduced in double whatever the policy: rate * elapsed outgrows float precision within
+     * a few thousand steps, while the reduced angle does not.
+     *
+     * @param target: Step to propagate to, not earlier than the current clock [uint64_t]
+     */
+    void propagateTo(uint64_t target){
+        if (target <= clock){
+            return;
+        }
+        const double elapsed = static_cast<double>(target - clock);
+        updateGroups();
+        jumpGroup<Propagator::Circular>(elapsed);
+        jumpGroup<Propagator::Kepler>(elapsed);
+        jumpGroup<Propagator::Perturbed>(elapsed);
+        clock = target;
+    }
+
+    /**
+     * @brief Rebuilds the groups if they were invalidated, one pass over the store
+     *
+     * Propagation calls it lazily; calling it directly moves the regrouping cost out of the
+     * next step.
+     */
+    void updateGroups(){
+        if (groups_valid){
+            return;
+        }
+        for (auto& group : groups){
+            group.clear();
+            group.reserve(size());
+        }
+        for (size_t i = 0; i < size(); ++i){
+            groups[static_cast<size_t>(propagator(i))].push_back(static_cast<uint32_t>(i));
+        }
+        groups_valid = true;
+    }
+
+private:
+    /**
+     * @brief Position of a satellite known to use propagator K
+     */
+    template <Propagator K>
+    std::tuple<float, float> positionAs(size_t i, Real mean_anomaly, Real arg_periapsis) const {
+        if constexpr (K == Propagator::Circular){
+            return calculate_sat_coordinates<P>(mean_anomaly, altitude[i], body_radius);
+        }
+        else {
+            return calculate_kepler_coordinates<P>(mean_anomaly, body_radius + altitude[i],
+                                                   eccentricity[i], arg_periapsis);
+        }
+    }
+
+    template <Propagator K>
+    void stepGroup(){
+        for (uint32_t i : groups[static_cast<size_t>(K)]){
+            prev_x[i] = x[i];
+            prev_y[i] = y[i];
+            angle[i] = std::fmod(angle[i] + rate[i], Real(360));
+            if constexpr (K == Propagator::Perturbed){
+                periapsis[i] = std::fmod(periapsis[i] + precession[i], Real(360));
+            }
+            auto [sat_x, sat_y] = positionAs<K>(i, angle[i], periapsis[i]);
+            x[i] = sat_x;
+            y[i] = sat_y;
+        }
+    }
+
+    template <Propagator K>
+    void jumpGroup(double elapsed){
+        for (uint32_t i : groups[static_cast<size_t>(K)]){
+            const Real before = static_cast<Real>(std::fmod(angle[i] + rate[i] * (elapsed - 1.0), 360.0));
+            Real before_periapsis = periapsis[i];
+            if constexpr (K == Propagator::Perturbed){
+                before_periapsis = static_cast<Real>(std::fmod(periapsis[i] + precession[i] * (elapsed - 1.0), 360.0));
+                periapsis[i] = static_cast<Real>(std::fmod(periapsis[i] + precession[i] * elapsed, 360.0));
+            }
+            auto [before_x, before_y] = positionAs<K>(i, before, before_periapsis);
+            prev_x[i] = before_x;
+            prev_y[i] = before_y;
+            angle[i] = static_cast<Real>(std::fmod(angle[i] + rate[i] * elapsed, 360.0));
+            auto [sat_x, sat_y] = positionAs<K>(i, angle[i], periapsis[i]);
+            x[i] = sat_x;
+            y[i] = sat_y;
+        }
+    }
+
+    std::vector<uint32_t> groups[PROPAGATORS];  /*Store indices of the satellites of each propagator, ascending*/
+    bool groups_valid = true;                   /*Whether groups match the elements*/
+};
+
+using SatelliteStore = BasicSatelliteStore<DoublePrecision>;      /*Accuracy runs, and everything interactive*/
+using FloatSatelliteStore = BasicSatelliteStore<FloatPrecision>;  /*High-throughput runs*/
@@ -1,7 +1,7 @@
 # imports
-from PyQt6.QtWidgets import (QApplication, QMainWindow, QWidget, QVBoxLayout, QPushButton, 
-                             QHBoxLayout, QSizePolicy, QLabel, QLineEdit)
-from PyQt6.QtCore import QProcess, QEventLoop
+from PyQt6.QtWidgets import (QApplication, QMainWindow, QWidget, QVBoxLayout,
+                             QHBoxLayout, QSizePolicy, QLabel, QSlider)
+from PyQt6.QtCore import QProcess, QEventLoop, QTimer, Qt
 from PyQt6.QtGui import QWindow
 import os
 import socket
@@ -45,6 +45,9 @@ logger.addHandler(handler)
 # Obtain path of parent directory
 CURRENT_DIRECTORY = Path(__file__).resolve().parent
 
+# Slider changes are batched and sent at most this often (ms)
+SEND_INTERVAL_MS = 16
+
 # PyQt6 GUI window class
 class SimWindow(QMainWindow):
     """The class that creates the satellite operation GUI
@@ -72,38 +75,56 @@ class SimWindow(QMainWindow):
 
         # Orbital speed 
         self.orbital_speed_layout = QHBoxLayout()
-        self.orbital_speed_label = QLabel("Orbital speed (km/h):")
-        self.orbital_speed = QLineEdit(self.main_widget)
-        self.orbital_speed.setPlaceholderText("10")
+        self.orbital_speed_label = QLabel("Orbital speed (deg/step):")
+        self.orbital_speed = QSlider(Qt.Orientation.Horizontal, self.main_widget)
+        self.orbital_speed.setRange(-20, 20)
+        self.orbital_speed.setValue(2)
+        self.orbital_speed_value = QLabel("2")
+        self.orbital_speed.valueChanged.connect(lambda value: self.queue_param("speed", value))
+        self.orbital_speed.valueChanged.connect(lambda value: self.orbital_speed_value.setNum(value))
         self.orbital_speed_layout.addWidget(self.orbital_speed_label)
         self.orbital_speed_layout.addWidget(self.orbital_speed)
+        self.orbital_speed_layout.addWidget(self.orbital_speed_value)
 
         # Altitude 
         self.altitude_layout = QHBoxLayout()
         self.altitude_label = QLabel("Altitude (km):")
-        self.altitude = QLineEdit(self.main_widget)
-        self.altitude.setPlaceholderText("10")
+        self.altitude = QSlider(Qt.Orientation.Horizontal, self.main_widget)
+        self.altitude.setRange(0, 36000)
+        self.altitude.setValue(10)
+        self.altitude_value = QLabel("10")
+        self.altitude.valueChanged.connect(lambda value: self.queue_param("altitude", value))
+        self.altitude.valueChanged.connect(lambda value: self.altitude_value.setNum(value))
         self.altitude_layout.addWidget(self.altitude_label)
         self.altitude_layout.addWidget(self.altitude)
-
-        # Send values to sim
-        self.send_params = QPushButton("Apply")
-        self.send_params.clicked.connect(self.send_data)
+        self.altitude_layout.addWidget(self.altitude_value)
+
+        # Latest value of every parameter changed since the last send
+        self.pending_params = {}
+        # Bytes of the current batch the simulator has not taken yet
+        self.unsent = b""
+        self.send_timer = QTimer(self)
+        self.send_timer.setInterval(SEND_INTERVAL_MS)
+        self.send_timer.timeout.connect(self.send_data)
+        # The simulator starts from its scenario's values, the first batch aligns it with the sliders
+        self.queue_slider_values()
 
         layout.addLayout(self.orbital_speed_layout)
         layout.addLayout(self.altitude_layout)
-        layout.addWidget(self.send_params)
         
         win_id = self.find_id(os.fspath(CURRENT_DIRECTORY/"sdl_orbitsim"))
         window = QWindow.fromWinId(win_id)
         widget = QWidget.createWindowContainer(window)
-        widget.setFixedSize(600, 600)
-        widget.setSizePolicy(QSizePolicy.Policy.Fixed, QSizePolicy.Policy.Fixed)
-        layout.addWidget(widget)
+        # The simulator follows the size of its window, let the container grow with ours
+        widget.setMinimumSize(200, 200)
+        widget.resize(600, 600)
+        widget.setSizePolicy(QSizePolicy.Policy.Expanding, QSizePolicy.Policy.Expanding)
+        layout.addWidget(widget, 1)
 
         self.process.readyReadStandardError.connect(self.handle_stderr)
 
-        self.main_widget.setFixedSize(400, 200)
+        self.main_widget.setMinimumSize(400, 200)
+        self.resize(600, 800)
         self.setCentralWidget(self.main_widget)
 
     def create_socket(self):
@@ -124,24 +145,54 @@ class SimWindow(QMainWindow):
         logger.info("Socket created. Listening for incoming connections")
 
 
+    def queue_param(self, key, value):
+        """Records a parameter change, sent with the next batch
+
+        Args:
+            key (str): Parameter name understood by the simulator
+            value (int): New value
+        """
+        self.pending_params[key] = value
+        if not self.send_timer.isActive():
+            self.send_timer.start()
+
+    def queue_slider_values(self):
+        """Queues the current value of every slider, sent once the simulator is connected
+        """
+        self.queue_param("speed", self.orbital_speed.value())
+        self.queue_param("altitude", self.altitude.value())
+
     def send_data(self):
-        """Sends satellite parameters to C++
+        """Sends the latest value of every changed parameter to C++, one "key=value" line each
+
+        The socket never blocks the GUI thread: whatever the simulator does not take now stays
+        in self.unsent for the next tick, and newer changes keep coalescing in
+        self.pending_params until that batch has gone out.
         """
-        orbital_speed = self.orbital_speed.text()
-        altitude = self.altitude.text()
-        logger.debug(f"Orbital speed: {orbital_speed} km/h -- Altitude: {altitude} km")
-        sat_data = f"{orbital_speed}, {altitude}"
+        if not self.unsent:
+            if not self.pending_params:
+                self.send_timer.stop()
+                return
+            self.unsent = "".join(f"{key}={value}\n" for key, value in self.pending_params.items()).encode()
+            self.pending_params.clear()
 
         try:
             if self.sat_connection is None or self.sat_connection.fileno() < 0:
                 self.sat_connection, self.sat_clientaddress = self.sat_server.accept()
+                self.sat_connection.setblocking(False)
                 logger.info("Accepted new connection")
-            
-            self.sat_connection.sendall(sat_data.encode())
-            logger.debug("Sent data to sdl_orbitsim.cpp")
-        except (IOError, UnicodeDecodeError) as e:
+
+            sent = self.sat_connection.send(self.unsent)
+            self.unsent = self.unsent[sent:]
+        except BlockingIOError:
+            # The simulator has not connected yet or its socket is full, retry on the next tick
+            pass
+        except IOError as e:
             logger.error(f"Error sending data: {e}")
             self.sat_connection = None
+            self.unsent = b""
+            # A new connection starts from the scenario's values again
+            self.queue_slider_values()
         
     def handle_stderr(self):
         error_data = self.process.readAllStandardError()
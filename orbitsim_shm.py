@@ -0,0 +1,154 @@
+# imports
+import mmap
+import os
+import struct
+import time
+
+import numpy as np
+
+# Layout of SharedStateHeader in shared_state.hpp
+HEADER_FORMAT = "<8sIIQQQQQd11Q"
+MAGIC = b"ORBSHM\0\0"
+VERSION = 2
+SEQUENCE_OFFSET = 32    # Byte offset of the seqlock counter in the header
+
+# SatelliteStore columns in the order of forEachSnapshotArray() in snapshot.hpp
+COLUMNS = (
+    ("id", np.uint32),
+    ("angle", np.float64),
+    ("rate", np.float64),
+    ("altitude", np.float64),
+    ("eccentricity", np.float64),
+    ("periapsis", np.float64),
+    ("precession", np.float64),
+    ("x", np.float32),
+    ("y", np.float32),
+    ("prev_x", np.float32),
+    ("prev_y", np.float32),
+)
+
+
+class Sample:
+    """A consistent copy of some columns of the simulation state
+
+    Attributes:
+        clock (int): Steps simulated when the sample was taken
+        body_radius (float): Radius of the central body (km)
+        columns (dict): NumPy array per requested column, one element per satellite
+    """
+    def __init__(self, clock, body_radius, columns):
+        self.clock = clock
+        self.body_radius = body_radius
+        self.columns = columns
+
+    def __getitem__(self, name):
+        return self.columns[name]
+
+
+class SharedState:
+    """Read-only view of the state a running sdl_orbitsim publishes to shared memory
+
+    The simulator publishes when its scenario contains "shared_memory <name>". Arrays are
+    mapped straight from the segment, so nothing is copied until a consistent sample is asked
+    for. The simulator updates the segment under a seqlock: sample() copies the requested
+    columns and retries if an update overlapped the copy.
+
+    Args:
+        name (str): Segment name given in the scenario, such as "/orbitsim"
+    """
+    def __init__(self, name="/orbitsim"):
+        self.path = os.path.join("/dev/shm", name.lstrip("/"))
+        self._file = open(self.path, "rb")
+        self._map = None
+        self._remap()
+
+    def _remap(self):
+        """Maps the whole segment again, needed when the simulator enlarged it
+
+        The old mapping stays alive as long as arrays handed out earlier refer to it.
+        """
+        self._map = mmap.mmap(self._file.fileno(), 0, prot=mmap.PROT_READ)
+        header = struct.unpack_from(HEADER_FORMAT, self._map)
+        magic, version, array_count = header[0], header[1], header[2]
+        if magic != MAGIC or version != VERSION or array_count != len(COLUMNS):
+            raise ValueError(f"{self.path} is not a version {VERSION} orbitsim state segment")
+        self._segment_size = header[3]
+        self._capacity = header[4]
+        self._offsets = header[9:]
+        self._sequence = np.frombuffer(self._map, dtype="<u8", count=1, offset=SEQUENCE_OFFSET)
+
+    def _header(self):
+        """Returns (segment_size, count, clock, body_radius) as currently written
+        """
+        header = struct.unpack_from(HEADER_FORMAT, self._map)
+        return header[3], header[6], header[7], header[8]
+
+    @property
+    def sequence(self):
+        """int: Seqlock counter, odd while the simulator is writing"""
+        return int(self._sequence[0])
+
+    def arrays(self):
+        """Maps every column without copying
+
+        The arrays alias the live segment: they change under the caller as the simulation
+        runs and may mix two steps. Use sample() for a consistent copy.
+
+        Returns:
+            dict: NumPy array per column, one element per satellite
+        """
+        segment_size, count, _, _ = self._header()
+        if segment_size != self._segment_size:
+            self._remap()
+        return {name: np.frombuffer(self._map, dtype=dtype, count=count, offset=offset)
+                for (name, dtype), offset in zip(COLUMNS, self._offsets)}
+
+    def sample(self, columns=("id", "x", "y"), timeout=1.0):
+        """Copies columns from a single simulation step
+
+        Args:
+            columns (tuple): Names of the columns to copy
+            timeout (float): Seconds to keep retrying while the simulator writes
+
+        Returns:
+            Sample: The copied columns and the step they belong to
+        """
+        deadline = time.monotonic() + timeout
+        while True:
+            before = self.sequence
+            if before % 2 == 0:
+                segment_size, count, clock, body_radius = self._header()
+                if segment_size != self._segment_size:
+                    self._remap()
+                    continue
+                views = self.arrays()
+                copies = {name: views[name].copy() for name in columns}
+                if self.sequence == before:
+                    return Sample(clock, body_radius, copies)
+            if time.monotonic() > deadline:
+                raise TimeoutError(f"{self.path} kept changing for {timeout} s")
+
+    def close(self):
+        """Unmaps the segment once no array handed out refers to it any more
+        """
+        self._sequence = None
+        self._map = None
+        self._file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+if __name__ == "__main__":
+    import sys
+
+    # Prints where the simulation is a few times a second
+    with SharedState(sys.argv[1] if len(sys.argv) > 1 else "/orbitsim") as state:
+        while True:
+            sample = state.sample()
+            print(f"step {sample.clock}: {len(sample['id'])} satellites, "
+                  f"first at ({sample['x'][:1]}, {sample['y'][:1]})")
+            time.sleep(0.25)
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+/**
+ * @brief Phases of a frame of the main loop
+ */
+enum class FramePhase {
+    Events,     /*SDL event polling*/
+    Socket,     /*Reading parameters from the GUI*/
+    Physics,    /*Propagation and conjunction screening*/
+    Render,     /*Culling and drawing*/
+    Present,    /*Presenting the frame*/
+    Count
+};
+
+inline const char* framePhaseName(FramePhase phase){
+    static const char* names[] = {"EVENTS", "SOCKET", "PHYSICS", "RENDER", "PRESENT"};
+    return names[static_cast<int>(phase)];
+}
+
+/**
+ * @brief Per-phase frame timing
+ *
+ * Records how long each phase of the frame took into a fixed window of recent frames and
+ * turns the window into p50/p95/p99 on demand. Timing a phase is one performance counter
+ * read; the percentiles are only recomputed when asked for, into preallocated scratch. They
+ * cover the completed frames only, so the one still being timed never skews them.
+ */
+class FrameProfiler {
+public:
+    static constexpr size_t WINDOW = 256;   /*Frames kept for the percentiles*/
+    static constexpr int PHASES = static_cast<int>(FramePhase::Count);
+
+    struct Percentiles {
+        float p50 = 0, p95 = 0, p99 = 0;
+    };
+
+    FrameProfiler() : ticks_to_ms(1000.0 / SDL_GetPerformanceFrequency()) {}
+
+    /**
+     * @brief Starts timing a new frame
+     */
+    void beginFrame(){
+        frame = static_cast<size_t>(frames_started % WINDOW);
+        ++frames_started;
+        for (auto& phase : samples){
+            phase[frame] = 0;
+        }
+        last_mark = SDL_GetPerformanceCounter();
+    }
+
+    /**
+     * @brief Attributes the time since the last mark to a phase
+     *
+     * @param phase: Phase that just finished [FramePhase]
+     */
+    void lap(FramePhase phase){
+        const Uint64 now = SDL_GetPerformanceCounter();
+        samples[static_cast<int>(phase)][frame] += static_cast<float>((now - last_mark) * ticks_to_ms);
+        last_mark = now;
+    }
+
+    /**
+     * @brief Drops the frame being timed
+     *
+     * For frames that end without drawing anything: their slot is left uncommitted and
+     * reused by the next beginFrame, so they never count as frames with free render and
+     * present phases.
+     */
+    void discardFrame(){
+        if (frames_started > 0){
+            --frames_started;
+        }
+    }
+
+    /**
+     * @brief Percentiles of a phase over the window (ms)
+     */
+    Percentiles percentiles(FramePhase phase){
+        const auto& phase_samples = samples[static_cast<int>(phase)];
+        const size_t n_frames = completedFrames();
+        for (size_t f = 0; f < n_frames; ++f){
+            scratch[f] = phase_samples[completedSlot(f)];
+        }
+        return fromScratch(n_frames);
+    }
+
+    /**
+     * @brief Percentiles of the whole frame over the window (ms)
+     */
+    Percentiles framePercentiles(){
+        const size_t n_frames = completedFrames();
+        for (size_t f = 0; f < n_frames; ++f){
+            scratch[f] = 0;
+            for (const auto& phase : samples){
+                scratch[f] += phase[completedSlot(f)];
+            }
+        }
+        return fromScratch(n_frames);
+    }
+
+    /**
+     * @brief Time recorded for a phase in the current frame (ms)
+     */
+    float current(FramePhase phase) const {
+        return samples[static_cast<int>(phase)][frame];
+    }
+
+private:
+    /**
+     * @brief Number of completed frames in the window, the slot of the current one excluded
+     */
+    size_t completedFrames() const {
+        return static_cast<size_t>(std::min<uint64_t>(frames_started > 0 ? frames_started - 1 : 0, WINDOW - 1));
+    }
+
+    /**
+     * @brief Slot of the f-th most recent completed frame, 0 being the last one
+     */
+    size_t completedSlot(size_t f) const {
+        return (frame + WINDOW - 1 - f) % WINDOW;
+    }
+
+    Percentiles fromScratch(size_t n_frames){
+        Percentiles result;
+        if (n_frames == 0){
+            return result;
+        }
+        auto at = [&](double q){
+            auto nth = scratch.begin() + static_cast<size_t>(q * (n_frames - 1));
+            std::nth_element(scratch.begin(), nth, scratch.begin() + n_frames);
+            return *nth;
+        };
+        result.p50 = at(0.50);
+        result.p95 = at(0.95);
+        result.p99 = at(0.99);
+        return result;
+    }
+
+    double ticks_to_ms;
+    Uint64 last_mark = 0;
+    size_t frame = 0;               /*Slot of the frame being timed*/
+    uint64_t frames_started = 0;    /*Frames begun since the start*/
+    std::array<std::array<float, WINDOW>, PHASES> samples{};
+    std::array<float, WINDOW> scratch{};
+};
+
+/**
+ * @brief On-screen performance overlay
+ *
+ * Draws the frame phase percentiles and the object and draw-call counts in the corner of the
+ * window with a built-in 3x5 pixel font. The text is only laid out again every
+ * REFRESH_FRAMES frames; in between, drawing the overlay is two batched fills, which keeps
+ * its cost far below a percent of the frame.
+ */
+class PerfHud {
+public:
+    static constexpr int REFRESH_FRAMES = 30;   /*Frames between text refreshes*/
+    static constexpr int SCALE = 2;             /*Size of a font pixel (px)*/
+
+    bool enabled = false;
+
+    /**
+     * @brief Counts shown next to the timings
+     */
+    struct Counters {
+        size_t objects = 0;     /*Satellites simulated*/
+        size_t visible = 0;     /*Satellites inside the viewport*/
+        uint64_t draw_calls = 0; /*Renderer calls issued for the frame*/
+        const char* lod = "";   /*Level of detail in use*/
+        size_t arena_high_water = 0; /*Most frame arena memory used by a frame (bytes)*/
+    };
+
+    /**
+     * @brief Draws the overlay
+     *
+     * @param renderer: A reference to the SDL renderer
+     * @param profiler: Frame timings to show
+     * @param counters: Counts to show
+     */
+    void draw(SDL_Renderer* renderer, FrameProfiler& profiler, const Counters& counters){
+        if (!enabled){
+            return;
+        }
+        const Uint64 start = SDL_GetPerformanceCounter();
+        if (frames_since_refresh++ % REFRESH_FRAMES == 0){
+            layout(profiler, counters);
+        }
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+        SDL_RenderFillRect(renderer, &background);
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        SDL_RenderFillRects(renderer, glyph_rects.data(), static_cast<int>(glyph_rects.size()));
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+        hud_ms = static_cast<float>(1000.0 * (SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency());
+    }
+
+private:
+    static constexpr int ADVANCE = 4 * SCALE;   /*Horizontal advance per character (px)*/
+    static constexpr int LINE = 7 * SCALE;      /*Vertical advance per line (px)*/
+    static constexpr int MARGIN = 4;            /*Padding around the text (px)*/
+
+    /**
+     * @brief Lays out the overlay text as rectangles
+     */
+    void layout(FrameProfiler& profiler, const Counters& counters){
+        glyph_rects.clear();
+        int line = 0;
+        int widest = 0;
+        char text[96];
+        auto print = [&](){
+            widest = std::max(widest, addText(text, MARGIN, MARGIN + line * LINE));
+            ++line;
+        };
+
+        snprintf(text, sizeof(text), "PHASE     P50    P95    P99 MS");
+        print();
+        for (int p = 0; p < FrameProfiler::PHASES; ++p){
+            const auto pct = profiler.percentiles(static_cast<FramePhase>(p));
+            snprintf(text, sizeof(text), "%-7s %6.2f %6.2f %6.2f", framePhaseName(static_cast<FramePhase>(p)),
+                     pct.p50, pct.p95, pct.p99);
+            print();
+        }
+        const auto frame = profiler.framePercentiles();
+        snprintf(text, sizeof(text), "FRAME   %6.2f %6.2f %6.2f", frame.p50, frame.p95, frame.p99);
+        print();
+        snprintf(text, sizeof(text), "OBJECTS %zu VISIBLE %zu", counters.objects, counters.visible);
+        print();
+        snprintf(text, sizeof(text), "DRAW CALLS %llu LOD %s", static_cast<unsigned long long>(counters.draw_calls),
+                 counters.lod);
+        print();
+        snprintf(text, sizeof(text), "ARENA PEAK %.1f KB", counters.arena_high_water / 1024.0);
+        print();
+        snprintf(text, sizeof(text), "HUD %.3f MS", hud_ms);
+        print();
+
+        background = {0, 0, widest + MARGIN, MARGIN * 2 + line * LINE - 2 * SCALE};
+    }
+
+    /**
+     * @brief Appends the rectangles of a line of text
+     *
+     * @return [int] The right edge of the text (px)
+     */
+    int addText(const char* text, int x, int y){
+        for (; *text; ++text, x += ADVANCE){
+            const uint16_t glyph = glyphBits(*text);
+            for (int row = 0; row < 5; ++row){
+                for (int col = 0; col < 3; ++col){
+                    if (glyph & (1u << (14 - (row * 3 + col)))){
+                        glyph_rects.push_back({x + col * SCALE, y + row * SCALE, SCALE, SCALE});
+                    }
+                }
+            }
+        }
+        return x;
+    }
+
+    /**
+     * @brief 3x5 glyph of a character, one bit per pixel, rows top to bottom
+     */
+    static uint16_t glyphBits(char c){
+        static const uint16_t digits[10] = {
+            0x7B6F, 0x2C97, 0x73E7, 0x73CF, 0x5BC9, 0x79CF, 0x79EF, 0x7249, 0x7BEF, 0x7BCF
+        };
+        static const uint16_t letters[26] = {
+            0x2BED, 0x6BAE, 0x3923, 0x6B6E, 0x79A7, 0x79A4, 0x396B, 0x5BED, 0x7497, 0x126A, 0x5BAD, 0x4927, 0x5FED,
+            0x6B6D, 0x2B6A, 0x6BA4, 0x2B73, 0x6BAD, 0x388E, 0x7492, 0x5B6F, 0x5B6A, 0x5BFD, 0x5AAD, 0x5A92, 0x72A7
+        };
+        if (c >= '0' && c <= '9'){
+            return digits[c - '0'];
+        }
+        if (c >= 'a' && c <= 'z'){
+            c = static_cast<char>(c - 'a' + 'A');
+        }
+        if (c >= 'A' && c <= 'Z'){
+            return letters[c - 'A'];
+        }
+        switch (c){
+            case '.': return 0x0002;
+            case ':': return 0x0410;
+            case '-': return 0x01C0;
+            case '/': return 0x12A4;
+            case '%': return 0x52A5;
+            default: return 0;
+        }
+    }
+
+    int frames_since_refresh = 0;
+    float hud_ms = 0;
+    SDL_Rect background = {0, 0, 0, 0};
+    std::vector<SDL_Rect> glyph_rects;
+};
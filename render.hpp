@@ -0,0 +1,315 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "aa_raster.hpp"
+#include "arena.hpp"
+#include "lod.hpp"
+
+constexpr int SATELLITE_RADIUS_PX = 10; /*On-screen radius of a satellite (px)*/
+
+/**
+ * @brief Counts of the work sent to the renderer, reset by the caller every frame
+ */
+struct RenderStats {
+    uint64_t draw_calls = 0; /*SDL draw and fill calls issued*/
+};
+
+inline RenderStats render_stats;
+
+/**
+ * @brief Draws a filled circle
+ * 
+ * Generates a circle of a specified radius, centre point, and fills it with the specified colour.
+ * Only the part of the circle inside the clip rectangle is visited, so a circle much larger than
+ * the viewport costs no more than the viewport itself
+ * 
+ * @param renderer: A reference to the SDL renderer
+ * @param centre_x: The x-coordinate of the centre of the circle (px)
+ * @param centre_y: The y-coordinate of the centre of the circle (px)
+ * @param radius: The radius of the circle (px)[int]
+ * @param colour: The RGBA-format colour to fill the circle with [SDL_colour]
+ * @param clip: The rectangle to restrict drawing to, or nullptr to draw the whole circle [SDL_Rect*]
+ * 
+ * @return Nothing
+ */
+inline void drawFilledCircle(SDL_Renderer* renderer, int centre_x, int centre_y, int radius, SDL_Color colour,
+                      const SDL_Rect* clip=nullptr){
+    SDL_SetRenderDrawColor(renderer, colour.r, colour.g, colour.b, colour.a);
+    const int diameter = radius * 2;
+    int w_begin = 0, w_end = diameter;
+    int h_begin = 0, h_end = diameter;
+    if (clip){
+        // Pixel x = centre_x + radius - w, so restrict w (and likewise h) to the clip rectangle
+        w_begin = std::max(w_begin, centre_x + radius - (clip->x + clip->w - 1));
+        w_end = std::min(w_end, centre_x + radius - clip->x + 1);
+        h_begin = std::max(h_begin, centre_y + radius - (clip->y + clip->h - 1));
+        h_end = std::min(h_end, centre_y + radius - clip->y + 1);
+    }
+    for(int w=w_begin; w < w_end; ++w){
+        for(int h=h_begin; h < h_end; ++h){
+            int dx = radius - w;
+            int dy = radius - h;
+            if (pow(dx,2) + pow(dy,2) <= pow(radius,2)){
+                SDL_RenderDrawPointF(renderer, centre_x + dx, centre_y + dy);
+                ++render_stats.draw_calls;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Cached filled-disk texture
+ *
+ * Rasterizes an anti-aliased disk once into a texture and then draws it with a single copy, so a disk
+ * costs one renderer call per frame instead of one per pixel. The texture is only rebuilt
+ * when the radius in pixels or the colour changes (zoom, window resize, DPI change) or when
+ * the renderer loses its textures. Disks larger than MAX_RADIUS_PX are drawn directly as one
+ * filled span per row, clipped to the viewport, rather than kept as a texture far larger than
+ * the window.
+ */
+class DiskSprite {
+public:
+    static constexpr int MAX_RADIUS_PX = 1024;
+
+    DiskSprite() = default;
+    DiskSprite(const DiskSprite&) = delete;
+    DiskSprite& operator=(const DiskSprite&) = delete;
+
+    ~DiskSprite(){
+        invalidate();
+    }
+
+    /**
+     * @brief Drops the texture, the next draw rebuilds it
+     */
+    void invalidate(){
+        if (texture){
+            SDL_DestroyTexture(texture);
+            texture = nullptr;
+        }
+    }
+
+    /**
+     * @brief Number of times the texture was rasterized
+     */
+    uint64_t rebuilds() const { return rebuild_count; }
+
+    /**
+     * @brief Pixels a disk drawn by draw() may touch
+     */
+    static SDL_Rect footprint(float centre_x, float centre_y, float radius){
+        const int r = static_cast<int>(std::lround(radius));
+        return {static_cast<int>(std::lround(centre_x)) - r, static_cast<int>(std::lround(centre_y)) - r,
+                2 * r + 1, 2 * r + 1};
+    }
+
+    /**
+     * @brief Draws the disk
+     *
+     * @param renderer: A reference to the SDL renderer
+     * @param centre_x: The x-coordinate of the centre of the disk (px)
+     * @param centre_y: The y-coordinate of the centre of the disk (px)
+     * @param radius: The radius of the disk (px)
+     * @param colour: The RGBA-format colour of the disk [SDL_colour]
+     * @param viewport: The viewport rectangle [SDL_Rect]
+     */
+    void draw(SDL_Renderer* renderer, float centre_x, float centre_y, float radius, SDL_Color colour,
+              const SDL_Rect& viewport){
+        const int r = static_cast<int>(std::lround(radius));
+        if (r > MAX_RADIUS_PX){
+            drawSpans(renderer, centre_x, centre_y, r, colour, viewport);
+            return;
+        }
+        if (!texture || r != radius_px || colour.r != cached.r || colour.g != cached.g ||
+            colour.b != cached.b || colour.a != cached.a){
+            rebuild(renderer, r, colour);
+        }
+        const SDL_Rect dest = footprint(centre_x, centre_y, radius);
+        if (texture){
+            SDL_RenderCopy(renderer, texture, nullptr, &dest);
+            ++render_stats.draw_calls;
+        }
+        else {
+            drawSpans(renderer, centre_x, centre_y, r, colour, viewport);
+        }
+    }
+
+private:
+    /**
+     * @brief Fills the disk row by row, one rectangle per row inside the viewport
+     *
+     * Fills the pixels within the radius of the centre, like drawFilledCircle(), with a number
+     * of renderer calls bounded by the viewport height instead of its area.
+     */
+    static void drawSpans(SDL_Renderer* renderer, float centre_x, float centre_y, int radius, SDL_Color colour,
+                          const SDL_Rect& viewport){
+        const int cx = static_cast<int>(centre_x);
+        const int cy = static_cast<int>(centre_y);
+        SDL_SetRenderDrawColor(renderer, colour.r, colour.g, colour.b, colour.a);
+        const int y_first = std::max(cy - radius, viewport.y);
+        const int y_last = std::min(cy + radius, viewport.y + viewport.h - 1);
+        for (int y = y_first; y <= y_last; ++y){
+            const int dy = y - cy;
+            const int half = static_cast<int>(std::sqrt(static_cast<double>(radius) * radius -
+                                                        static_cast<double>(dy) * dy));
+            const int x0 = std::max(cx - half, viewport.x);
+            const int x1 = std::min(cx + half, viewport.x + viewport.w - 1);
+            if (x0 > x1){
+                continue;
+            }
+            const SDL_Rect span = {x0, y, x1 - x0 + 1, 1};
+            SDL_RenderFillRect(renderer, &span);
+            ++render_stats.draw_calls;
+        }
+    }
+
+    /**
+     * @brief Fills the texture with the anti-aliased disk, coverage going into the alpha channel
+     */
+    void rebuild(SDL_Renderer* renderer, int radius, SDL_Color colour){
+        invalidate();
+        const int size = 2 * radius + 1;
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, size, size);
+        if (!texture){
+            return;
+        }
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        const uint32_t rgb = static_cast<uint32_t>(colour.r) << 16 | static_cast<uint32_t>(colour.g) << 8 | colour.b;
+        pixels.assign(static_cast<size_t>(size) * size, 0);
+        // Centred on the middle pixel, the edge ends half a pixel inside the texture border
+        const AaDisk disk{radius + 0.5f, radius + 0.5f, static_cast<float>(radius)};
+        for (int y = 0; y < size; ++y){
+            uint32_t* row = pixels.data() + static_cast<size_t>(y) * size;
+            for (int x = 0; x < size; ++x){
+                const long alpha = std::lround(disk.coverage(x + 0.5f, y + 0.5f) * colour.a);
+                if (alpha > 0){
+                    row[x] = static_cast<uint32_t>(alpha) << 24 | rgb;
+                }
+            }
+        }
+        SDL_UpdateTexture(texture, nullptr, pixels.data(), size * static_cast<int>(sizeof(uint32_t)));
+        radius_px = radius;
+        cached = colour;
+        ++rebuild_count;
+    }
+
+    SDL_Texture* texture = nullptr;
+    int radius_px = -1;                 /*Radius the texture was built for (px)*/
+    SDL_Color cached = {0, 0, 0, 0};    /*Colour the texture was built with*/
+    uint64_t rebuild_count = 0;
+    std::vector<uint32_t> pixels;       /*Staging buffer for the texture contents*/
+};
+
+/**
+ * @brief Recent positions of one satellite, oldest first
+ *
+ * Fixed-size ring buffer of world positions (km), so keeping a trail never allocates.
+ */
+class Trail {
+public:
+    static constexpr size_t LENGTH = 64;
+
+    void push(double x, double y){
+        points[(head + count) % LENGTH] = {static_cast<float>(x), static_cast<float>(y)};
+        if (count < LENGTH){
+            ++count;
+        }
+        else {
+            head = (head + 1) % LENGTH;
+        }
+    }
+
+    void clear(){
+        head = count = 0;
+    }
+
+    size_t size() const { return count; }
+
+    const SDL_FPoint& operator[](size_t i) const { return points[(head + i) % LENGTH]; }
+
+private:
+    SDL_FPoint points[LENGTH] = {};
+    size_t head = 0;    /*Index of the oldest position*/
+    size_t count = 0;
+};
+
+/**
+ * @brief Draws a circle outline as a closed polyline
+ *
+ * SDL lines are not anti-aliased; the software rasterizer draws the same ring anti-aliased.
+ *
+ * @param renderer: A reference to the SDL renderer
+ * @param centre_x: The x-coordinate of the centre of the circle (px)
+ * @param centre_y: The y-coordinate of the centre of the circle (px)
+ * @param radius: The radius of the circle (px) [float]
+ * @param colour: The RGBA-format colour of the outline [SDL_colour]
+ * @param arena: Frame arena holding the vertices
+ */
+inline void drawRing(SDL_Renderer* renderer, float centre_x, float centre_y, float radius, SDL_Color colour,
+                     FrameArena& arena){
+    // Segments about 8 px long keep the polygon indistinguishable from the circle
+    const int segments = std::clamp(static_cast<int>(2 * M_PI * radius / 8), 32, 2048);
+    SDL_FPoint* vertices = arena.alloc<SDL_FPoint>(segments + 1);
+    for (int i = 0; i <= segments; ++i){
+        const double angle = 2 * M_PI * i / segments;
+        vertices[i] = {centre_x + radius * static_cast<float>(std::cos(angle)),
+                       centre_y + radius * static_cast<float>(std::sin(angle))};
+    }
+    SDL_SetRenderDrawColor(renderer, colour.r, colour.g, colour.b, colour.a);
+    SDL_RenderDrawLinesF(renderer, vertices, segments + 1);
+    ++render_stats.draw_calls;
+}
+
+/**
+ * @brief Draws the visible satellites
+ * 
+ * Draws every satellite at the requested level of detail: a filled disk each, a single pixel
+ * each in one batched call, or the density of satellites per screen cell
+ * 
+ * @param renderer: A reference to the SDL renderer
+ * @param visible: Screen positions of the satellites inside the viewport (px)
+ * @param mode: Level of detail to draw at [LodMode]
+ * @param disk: Cached satellite disk
+ * @param radius: The radius of a satellite disk (px) [float]
+ * @param density: Density grid reused between frames
+ * @param viewport: The viewport rectangle [SDL_Rect]
+ * @param colour: The RGBA-format colour of the satellites [SDL_colour]
+ */
+inline void drawSatellites(SDL_Renderer* renderer, const ArenaArray<SDL_FPoint>& visible, LodMode mode,
+                    DiskSprite& disk, float radius, DensityGrid& density, const SDL_Rect& viewport,
+                    SDL_Color colour){
+    if (mode == LodMode::Disk){
+        for (const SDL_FPoint& sat : visible){
+            disk.draw(renderer, sat.x, sat.y, radius, colour, viewport);
+        }
+    }
+    else if (mode == LodMode::Point){
+        SDL_SetRenderDrawColor(renderer, colour.r, colour.g, colour.b, colour.a);
+        SDL_RenderDrawPointsF(renderer, visible.data(), static_cast<int>(visible.size()));
+        ++render_stats.draw_calls;
+    }
+    else {
+        density.reset(viewport.w, viewport.h);
+        for (const SDL_FPoint& sat : visible){
+            density.add(sat.x, sat.y);
+        }
+        const auto& levels = density.build();
+        for (int level = 0; level < DensityGrid::LEVELS; ++level){
+            if (levels[level].empty()){
+                continue;
+            }
+            // Scale the satellite colour from a dim floor up to full brightness
+            const int scale = 64 + (255 - 64) * (level + 1) / DensityGrid::LEVELS;
+            SDL_SetRenderDrawColor(renderer, colour.r * scale / 255, colour.g * scale / 255,
+                                   colour.b * scale / 255, colour.a);
+            SDL_RenderFillRects(renderer, levels[level].data(), static_cast<int>(levels[level].size()));
+            ++render_stats.draw_calls;
+        }
+    }
+}
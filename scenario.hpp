@@ -0,0 +1,339 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "event_scheduler.hpp"
+#include "orbit.hpp"
+
+/*
+ * Scenario files describe a simulation, one directive per line:
+ *
+ *   satellite <altitude> <rate> [angle] [eccentricity] [periapsis] [precession]
+ *   shell <count> <altitude> <rate> [eccentricity]
+ *   body <radius>                  central body, before any satellite
+ *   integrator auto|step|analytic
+ *   timestep <scale>               multiplies the rate and precession of every satellite
+ *   gui_satellite <rate> <altitude>
+ *   socket_path <path>
+ *   window <width> <height>
+ *   delay_ms <ms>
+ *   km_per_px <zoom>
+ *   conjunction_threshold <km>
+ *   lod <disk limit> <point limit> <frame budget ms>
+ *   renderer sdl|software
+ *   redraw on_demand|continuous
+ *   shared_memory <name>           publish the state for orbitsim_shm.py, e.g. /orbitsim
+ *   event <step> burn <satellite> <altitude> <rate> [eccentricity]
+ *   event <step> rate <satellite> <rate>
+ *   event <step> altitude <satellite> <altitude>
+ *   event <step> pause
+ *   event <step> warp <time warp>
+ *
+ * Altitudes and radii are in km, rates and precessions in degrees per step and angles in
+ * degrees. The precession turns the periapsis of an eccentric orbit every step. A shell
+ * spreads `count` satellites evenly in phase on the same orbit. Events apply when the
+ * simulation reaches their step; satellites are numbered from 0 in the order the file adds
+ * them. Everything after '#' is a comment. Directives that are left out keep the defaults of
+ * SimConfig.
+ */
+
+/**
+ * @brief How the store is advanced each frame
+ */
+enum class Integrator {
+    Auto,       /*Step one at a time, jump in closed form under large time warps*/
+    Step,       /*Always step one at a time, screening every step*/
+    Analytic    /*Always jump in closed form, screening the last step of the frame*/
+};
+
+/**
+ * @brief Simulation settings read from a scenario
+ */
+struct SimConfig {
+    std::string socket_path = "/tmp/data_socket"; /*Path to the GUI socket*/
+    int window_w = 600;                 /*Initial window width (px)*/
+    int window_h = 600;                 /*Initial window height (px)*/
+    int delay_ms = 10;                  /*Delay at the start of every frame (ms)*/
+    double km_per_px = 50;              /*Initial zoom level (km per pixel)*/
+    float conjunction_threshold = 5.0f; /*Miss distance that raises a close-approach alert (km)*/
+    Integrator integrator = Integrator::Auto;
+    double timestep = 1.0;              /*Scale applied to every satellite rate and precession*/
+    int gui_speed = 2;                  /*Initial rate of the GUI-controlled satellite (degrees per step)*/
+    int gui_altitude = 10;              /*Initial altitude of the GUI-controlled satellite (km)*/
+    size_t lod_disk_limit = 2000;       /*Most visible satellites drawn as disks*/
+    size_t lod_point_limit = 50000;     /*Most visible satellites drawn as points*/
+    double lod_frame_budget_ms = 8.0;   /*Time the satellite pass may take per frame (ms)*/
+    bool software_raster = false;       /*Rasterize on the CPU in parallel tiles instead of through SDL*/
+    bool redraw_on_demand = true;       /*Sleep until an event or GUI message while nothing moves*/
+    std::string shared_memory;          /*Shared-memory segment the state is published to, none if empty*/
+    std::vector<SimEvent> events;       /*Events to schedule, in file order*/
+};
+
+/**
+ * @brief Splits a line into whitespace-separated fields
+ */
+inline size_t splitFields(std::string_view line, std::string_view* fields, size_t max_fields){
+    size_t n = 0;
+    size_t pos = 0;
+    while (n < max_fields){
+        pos = line.find_first_not_of(" \t\r", pos);
+        if (pos == std::string_view::npos){
+            break;
+        }
+        const size_t end = line.find_first_of(" \t\r", pos);
+        fields[n++] = line.substr(pos, end == std::string_view::npos ? std::string_view::npos : end - pos);
+        if (end == std::string_view::npos){
+            break;
+        }
+        pos = end;
+    }
+    return n;
+}
+
+/**
+ * @brief Parses a whole field as a number
+ *
+ * @return [bool] True if the field is a number and nothing else
+ */
+template <typename T>
+bool parseField(std::string_view field, T& value){
+    const auto [end, ec] = std::from_chars(field.data(), field.data() + field.size(), value);
+    return ec == std::errc() && end == field.data() + field.size();
+}
+
+/**
+ * @brief Loads a scenario file
+ *
+ * The file is read in one go and parsed in place, without a stream per line, so scenarios
+ * with millions of satellites load as fast as the disk delivers them.
+ *
+ * @param path: Scenario file path
+ * @param store: Store the satellites are added to
+ * @param config: Settings overridden by the scenario
+ * @return [bool] True if the whole file was valid, errors are reported with their line
+ */
+template <typename P>
+bool loadScenario(const char* path, BasicSatelliteStore<P>& store, SimConfig& config){
+    FILE* in = fopen(path, "rb");
+    if (!in){
+        perror("fopen");
+        return false;
+    }
+    std::string text;
+    char chunk[1 << 16];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), in)) > 0){
+        text.append(chunk, got);
+    }
+    fclose(in);
+
+    std::string_view rest(text);
+    size_t line_no = 0;
+    while (!rest.empty()){
+        const size_t newline = rest.find('\n');
+        std::string_view line = rest.substr(0, newline);
+        rest = newline == std::string_view::npos ? std::string_view() : rest.substr(newline + 1);
+        ++line_no;
+        line = line.substr(0, line.find('#'));
+
+        std::string_view fields[8];
+        const size_t n = splitFields(line, fields, 8);
+        if (n == 0){
+            continue;
+        }
+        auto fail = [&](const char* reason){
+            std::cerr << path << ":" << line_no << ": " << reason << std::endl;
+            return false;
+        };
+        // Directives taking a fixed number of numeric values
+        auto values = [&](size_t count, auto&... out){
+            size_t f = 1;
+            return n == count + 1 && (parseField(fields[f++], out) && ...);
+        };
+
+        if (fields[0] == "satellite"){
+            double params[6] = {0, 0, 0, 0, 0, 0};
+            if (n < 3 || n > 7){
+                return fail("expected: satellite <altitude> <rate> [angle] [eccentricity] [periapsis] [precession]");
+            }
+            for (size_t f = 1; f < n; ++f){
+                if (!parseField(fields[f], params[f - 1])){
+                    return fail("invalid number");
+                }
+            }
+            if (params[3] < 0 || params[3] >= 1){
+                return fail("eccentricity must be in [0, 1)");
+            }
+            store.add(params[0], params[1], params[2], params[3], params[4], params[5]);
+        }
+        else if (fields[0] == "shell"){
+            size_t count = 0;
+            double altitude = 0, rate = 0, eccentricity = 0;
+            if (n < 4 || n > 5 || !parseField(fields[1], count) || !parseField(fields[2], altitude) ||
+                !parseField(fields[3], rate) || (n == 5 && !parseField(fields[4], eccentricity))){
+                return fail("expected: shell <count> <altitude> <rate> [eccentricity]");
+            }
+            if (eccentricity < 0 || eccentricity >= 1){
+                return fail("eccentricity must be in [0, 1)");
+            }
+            for (size_t i = 0; i < count; ++i){
+                store.add(altitude, rate, 360.0 * i / count, eccentricity);
+            }
+        }
+        else if (fields[0] == "body"){
+            if (!values(1, store.body_radius) || store.body_radius <= 0){
+                return fail("expected: body <radius>");
+            }
+            if (store.size()){
+                return fail("the body must be set before any satellite");
+            }
+        }
+        else if (fields[0] == "integrator"){
+            if (n == 2 && fields[1] == "auto"){
+                config.integrator = Integrator::Auto;
+            }
+            else if (n == 2 && fields[1] == "step"){
+                config.integrator = Integrator::Step;
+            }
+            else if (n == 2 && fields[1] == "analytic"){
+                config.integrator = Integrator::Analytic;
+            }
+            else {
+                return fail("expected: integrator auto|step|analytic");
+            }
+        }
+        else if (fields[0] == "timestep"){
+            if (!values(1, config.timestep) || config.timestep <= 0){
+                return fail("expected: timestep <scale>");
+            }
+        }
+        else if (fields[0] == "gui_satellite"){
+            if (!values(2, config.gui_speed, config.gui_altitude)){
+                return fail("expected: gui_satellite <rate> <altitude>");
+            }
+        }
+        else if (fields[0] == "socket_path"){
+            if (n != 2){
+                return fail("expected: socket_path <path>");
+            }
+            config.socket_path = std::string(fields[1]);
+        }
+        else if (fields[0] == "window"){
+            if (!values(2, config.window_w, config.window_h) || config.window_w <= 0 || config.window_h <= 0){
+                return fail("expected: window <width> <height>");
+            }
+        }
+        else if (fields[0] == "delay_ms"){
+            if (!values(1, config.delay_ms) || config.delay_ms < 0){
+                return fail("expected: delay_ms <ms>");
+            }
+        }
+        else if (fields[0] == "km_per_px"){
+            if (!values(1, config.km_per_px) || config.km_per_px <= 0){
+                return fail("expected: km_per_px <zoom>");
+            }
+        }
+        else if (fields[0] == "conjunction_threshold"){
+            if (!values(1, config.conjunction_threshold)){
+                return fail("expected: conjunction_threshold <km>");
+            }
+        }
+        else if (fields[0] == "lod"){
+            if (!values(3, config.lod_disk_limit, config.lod_point_limit, config.lod_frame_budget_ms)){
+                return fail("expected: lod <disk limit> <point limit> <frame budget ms>");
+            }
+        }
+        else if (fields[0] == "renderer"){
+            if (n == 2 && (fields[1] == "sdl" || fields[1] == "software")){
+                config.software_raster = fields[1] == "software";
+            }
+            else {
+                return fail("expected: renderer sdl|software");
+            }
+        }
+        else if (fields[0] == "redraw"){
+            if (n == 2 && (fields[1] == "on_demand" || fields[1] == "continuous")){
+                config.redraw_on_demand = fields[1] == "on_demand";
+            }
+            else {
+                return fail("expected: redraw on_demand|continuous");
+            }
+        }
+        else if (fields[0] == "shared_memory"){
+            if (n != 2 || fields[1].size() < 2 || fields[1][0] != '/' || fields[1].find('/', 1) != std::string_view::npos){
+                return fail("expected: shared_memory /<name>");
+            }
+            config.shared_memory = std::string(fields[1]);
+        }
+        else if (fields[0] == "event"){
+            SimEvent event = {SimEvent::Pause, 0, 0, {0, 0, NAN}};
+            bool valid = n >= 3 && parseField(fields[1], event.step);
+            auto satellite = [&](size_t min_values, size_t max_values){
+                return n >= 4 + min_values && n <= 4 + max_values && parseField(fields[3], event.satellite);
+            };
+            if (valid && fields[2] == "burn"){
+                event.kind = SimEvent::Burn;
+                valid = satellite(2, 3) && parseField(fields[4], event.value[0]) && parseField(fields[5], event.value[1])
+                     && (n == 6 || (parseField(fields[6], event.value[2]) && event.value[2] >= 0 && event.value[2] < 1));
+            }
+            else if (valid && (fields[2] == "rate" || fields[2] == "altitude")){
+                event.kind = fields[2] == "rate" ? SimEvent::Rate : SimEvent::Altitude;
+                valid = satellite(1, 1) && parseField(fields[4], event.value[0]);
+            }
+            else if (valid && fields[2] == "pause"){
+                valid = n == 3;
+            }
+            else if (valid && fields[2] == "warp"){
+                event.kind = SimEvent::Warp;
+                valid = n == 4 && parseField(fields[3], event.value[0]) && event.value[0] >= 1;
+            }
+            else {
+                valid = false;
+            }
+            if (!valid){
+                return fail("expected: event <step> burn <satellite> <altitude> <rate> [eccentricity] | "
+                            "rate|altitude <satellite> <value> | pause | warp <time warp>");
+            }
+            config.events.push_back(event);
+        }
+        else {
+            return fail("unknown directive");
+        }
+    }
+
+    // Events may name satellites added further down the file
+    for (const SimEvent& event : config.events){
+        const bool targeted = event.kind == SimEvent::Burn || event.kind == SimEvent::Rate
+                           || event.kind == SimEvent::Altitude;
+        if (targeted && event.satellite >= store.size()){
+            std::cerr << path << ": event at step " << event.step << " names satellite " << event.satellite
+                      << " of " << store.size() << std::endl;
+            return false;
+        }
+    }
+
+    // Rates are given per nominal step, a longer step covers proportionally more of the orbit
+    // and, for precessing orbits, proportionally more of the periapsis drift
+    if (config.timestep != 1.0){
+        for (size_t i = 0; i < store.size(); ++i){
+            store.rate[i] *= config.timestep;
+            store.precession[i] *= config.timestep;
+        }
+        for (SimEvent& event : config.events){
+            if (event.kind == SimEvent::Burn){
+                event.value[1] *= config.timestep;
+            }
+            else if (event.kind == SimEvent::Rate){
+                event.value[0] *= config.timestep;
+            }
+        }
+    }
+    return true;
+}
@@ -12,114 +12,41 @@
 #include <tuple>
 #include <vector>
 #include <fcntl.h>
+#include <algorithm>
+#include <cstdint>
 #include <sys/poll.h>
+#include <chrono>
 
-constexpr int DELAY_MS = 10; /*SDL delay time in milliseconds*/
+#include "orbit.hpp"
+#include "conjunction.hpp"
+#include "event_scheduler.hpp"
+#include "camera.hpp"
+#include "render.hpp"
+#include "frame_cache.hpp"
+#include "frame_capture.hpp"
+#include "software_raster.hpp"
+#include "ipc.hpp"
+#include "perf_hud.hpp"
+#include "trace.hpp"
+#include "alloc_counter.hpp"
+#include "arena.hpp"
+#include "snapshot.hpp"
+#include "ephemeris.hpp"
+#include "trajectory_recorder.hpp"
+#include "scenario.hpp"
+#include "shared_state.hpp"
+#include "frame_loop.hpp"
 
-/**
- * @brief Draws a filled circle
- * 
- * Generates a circle of a specified radius, centre point, and fills it with the specified colour
- * 
- * @param renderer: A reference to the SDL renderer
- * @param centre_x: The x-coordinate of the centre of the circle (px)
- * @param centre_y: The y-coordinate of the centre of the circle (px)
- * @param radius: The radius of the circle (px)[int]
- * @param colour: The RGBA-format colour to fill the circle with [SDL_colour]
- * 
- * @return Nothing
- */
-void drawFilledCircle(SDL_Renderer* renderer, int centre_x, int centre_y, int radius, SDL_Color colour){
-    SDL_SetRenderDrawColor(renderer, colour.r, colour.g, colour.b, colour.a);
-    const int diameter = radius * 2;
-    for(int w=0; w < diameter; ++w){
-        for(int h=0; h <diameter; ++h){
-            int dx = radius - w;
-            int dy = radius - h;
-            if (pow(dx,2) + pow(dy,2) <= pow(radius,2)){
-                SDL_RenderDrawPointF(renderer, centre_x + dx, centre_y + dy);
-            }
-        }
-    }
-}
-
-/**
- * @brief Calculates the satellite's X and Y coordinates
- * 
- * Receives the angle of the satellite and calculates its X- and Y-coordinates
- * 
- * @param angle: Satellite angle [int]
- * @return [std::tuple] The X- and Y-coordinates of the satellite respectively
-*/
-std::tuple<float, float> calculate_sat_coordinates(int angle, int altitude=100){
-    float sat_x = 300 + (altitude * cos(M_PI * angle / 180.0));
-    float sat_y = 300 + (altitude * sin(M_PI * angle / 180.0));
-    return {sat_x, sat_y};
-}
-
-/**
- * @brief Create a Socket object 
- * 
- * Creates a client socket object and establishes a connection request to the server
- * 
- * @param socket_path: The path to the socket
- * @return [int] The client socket descriptor
- */
-int createSocket(const char* socket_path){
-    // Create a Unix domain socket
-    int client_socket = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (client_socket == -1){
-        std::cerr << "Error creating socket" << std::endl;
-        return 1;
-    }
-
-    // Set up socket address
-    struct sockaddr_un address;
-    memset(&address, 0, sizeof(address));
-    address.sun_family = AF_UNIX;
-    strncpy(address.sun_path, socket_path, sizeof(address.sun_path)-1);
-
-    // connect to the server
-    bool connected = False;
-
-    int flags = fcntl(client_socket, F_GETFL, 0);
-    if (fcntl(client_socket, F_SETFL, flags | O_NONBLOCK) == -1)
-    {
-        perror("fcntl");
-        return 1;
-    }
-
-    // counter for connection patience
-    int fallback = 0;
-    while (!connected)
-    {
-        printf("Attempting to connect to server... ");
-        fflush(stdout);
-        if (connect(client_socket, (struct sockaddr*)&address, sizeof(address)) == -1){
-            if (errno == ENOENT || errno == ECONNREFUSED) {
-                if (fallback > 2){
-                    return 0;
-                }
-                std::cerr << "Retrying connection";
-                SDL_Delay(1000);
-                ++fallback;
-            }
-            else {
-                std::cerr << "Error connecting to socket: " << strerror(errno) << std::endl;
-                close(client_socket);
-                return 1;
-            }
-
-        }
-        else {
-            printf("Connection to server established");
-            fflush(stdout);
-            connected = True;
-        }
-    }     
-
-    return client_socket;
-}
+constexpr double ZOOM_STEP = 1.25; /*Zoom factor applied per mouse wheel notch*/
+constexpr int ALLOCATION_WARMUP_FRAMES = 120; /*Frames allowed to allocate before the steady state is enforced*/
+constexpr const char* TRACE_PATH = "orbitsim_trace.json"; /*Where F4 writes the recorded trace*/
+constexpr const char* TRAJECTORY_PATH = "orbitsim_trajectory.bin"; /*Where F6 records trajectories*/
+constexpr uint64_t TRAJECTORY_DECIMATION = 10; /*Steps between recorded trajectory samples*/
+constexpr const char* SNAPSHOT_PATH = "orbitsim.snapshot"; /*Where F5 saves and F9 restores the simulation*/
+constexpr uint32_t REPLAY_SEGMENT_STEPS = 32; /*Steps per polynomial segment of a replayed window*/
+constexpr int REPLAY_DEGREE = 14; /*Degree of the polynomials of a replayed window*/
+constexpr double REPLAY_MAX_OBJECT_STEPS = 5e6; /*Largest window, times satellites, fitted on a restore*/
+constexpr const char* CAPTURE_PREFIX = "orbitsim_frame"; /*Where F8 captures frames, numbered after the prefix*/
 
 /**
  * @brief Get SDL window ID 
@@ -138,100 +65,208 @@ void captureSDLWindowID(SDL_Window* win){
 }
 
 /**
- * @brief Get satellite data
- * 
- * Receives satellite data (orbital speed (km/h) and altitude (km)) from Python and packages
- * them into a vector container to return them for use
- * 
- * @param socket_desc: Integer descriptor of the client socket
- * @param buf: Character buffer array for received data
- * @return Int vector of satellite parameters
+ * @brief Runs a scenario without a window and writes its ephemerides
+ *
+ * Loads the scenario, propagates it for the requested number of steps and records the
+ * position of every satellite every `every` steps. Unless the scenario asks for the step
+ * integrator, orbits are evaluated in closed form so only the recorded steps are computed.
+ * Scheduled events apply at their step; pauses and time warps have no meaning here and are
+ * skipped. Reports the simulation rate on stdout.
+ *
+ * With a capture prefix, every recorded step is also drawn by the CPU rasterizer straight into
+ * the frame capture buffers, at the window size and zoom of the scenario, and written as an
+ * image sequence. No window or SDL video subsystem is needed, and the run goes as fast as the
+ * rasterizer and the disk allow.
+ *
+ * The precision policy P picks the store: float elements for throughput, double for accuracy.
+ *
+ * @param scenario_path: Scenario file path
+ * @param steps: Number of steps to simulate [uint64_t]
+ * @param out_path: Ephemeris output file path
+ * @param every: Steps between recorded samples [uint64_t]
+ * @param format: Output file format [TrajectoryFormat]
+ * @param capture_prefix: Path prefix of the captured frames, no frames if empty
+ * @return [int] Process exit status
  */
-std::vector<int> getSatelliteData(int socket_desc, char* buf, std::vector<int> default_params={2, 10}){
-    std::vector<int> sat_params; /*Satellite parameters*/
-    std::cout << "Inside getSatelliteData\n" << std::flush;
+template <typename P>
+int runBatch(const char* scenario_path, uint64_t steps, const std::string& out_path, uint64_t every,
+             TrajectoryFormat format, const std::string& capture_prefix){
+    BasicSatelliteStore<P> satellites;
+    SimConfig config;
+    if (!loadScenario(scenario_path, satellites, config)){
+        return 1;
+    }
+    if (satellites.size() == 0){
+        std::cerr << scenario_path << " has no satellites" << std::endl;
+        return 1;
+    }
+    every = std::max<uint64_t>(every, 1);
 
-    struct pollfd fds[1];
-    fds[0].fd = socket_desc;
-    fds[0].events = POLLIN; // Interested in readability events
+    const auto start = std::chrono::steady_clock::now();
+    TrajectoryRecorder recorder;
+    if (!recorder.start(out_path, satellites, {}, format, every, true)){
+        return 1;
+    }
 
-    while (true)
-    {
-        int ret = poll(fds, 1, 10); // Wait indefinitely
-        if (ret == -1)
-        {
-            std::cerr << "Error: " << strerror(errno);
-            break;
+    // Headless rendering: the whole scene at the scenario's default view
+    const Camera camera = {0, 0, config.km_per_px, config.window_w, config.window_h};
+    const SDL_Rect viewport = {0, 0, camera.viewport_w, camera.viewport_h};
+    FrameCapture capture;
+    SoftwareRaster raster;
+    WorkerPool workers(capture_prefix.empty() ? 0 : std::max(1u, std::thread::hardware_concurrency()) - 1);
+    LodPolicy lod;
+    lod.disk_limit = config.lod_disk_limit;
+    lod.point_limit = config.lod_point_limit;
+    DensityGrid density;
+    if (!capture_prefix.empty() && !capture.start(capture_prefix, camera.viewport_w, camera.viewport_h, true)){
+        return 1;
+    }
+    auto captureFrame = [&](){
+        uint32_t* pixels = capture.acquire();
+        if (!pixels){
+            return;
         }
-        else if (ret == 0)
-        {
-            std::cout << "No data available on socket";
-            sat_params = default_params;
-            break;
+        FrameArena& arena = threadArena();
+        raster.begin(camera.viewport_w, camera.viewport_h, {0,0,0,255});
+        auto [earth_x, earth_y] = camera.worldToScreen(0, 0);
+        const float earth_radius = camera.toPixels(satellites.body_radius);
+        if (camera.isVisible(earth_x, earth_y, earth_radius)){
+            raster.disk(earth_x, earth_y, earth_radius, {0,0,255,255});
+        }
+        ArenaArray<SDL_FPoint> visible(arena, satellites.size());
+        for (size_t i = 0; i < satellites.size(); ++i){
+            auto [screen_x, screen_y] = camera.worldToScreen(satellites.x[i], satellites.y[i]);
+            if (camera.isVisible(screen_x, screen_y, SATELLITE_RADIUS_PX)){
+                visible.push_back({screen_x, screen_y});
+            }
         }
+        // No frame budget to keep, the level of detail only follows the visible count
+        drawSatellitesSoftware(raster, visible, lod.select(visible.size(), 0), SATELLITE_RADIUS_PX, density, viewport,
+                               {0,255,0,255});
+        raster.rasterize(pixels, camera.viewport_w * 4, workers);
+        capture.submit(pixels, satellites.clock);
+        arena.reset();
+    };
 
-        std::cout << "[getSatelliteData] Further tracking..." << std::endl;
-        // Check for readability event
-        if (fds[0].revents & POLLIN)
-        {
-            std::cout << "Data available in socket\n" << std::flush;
-            // Data is available on socket. Attempt to receive it
-            ssize_t bytes_received = recv(socket_desc, buf, sizeof(buf)-1, 0);
-            if (bytes_received == -1)
-            {
-                if (errno == EWOULDBLOCK)
-                {
-                    std::cerr << "Blocking issue";
-                    continue;
-                }
-                else
-                {
-                    std::cerr << "Issue with recv";
-                    break;
+    EventScheduler scheduler;
+    for (const SimEvent& event : config.events){
+        scheduler.schedule(event);
+    }
+
+    recorder.record(satellites);
+    if (capture.capturing()){
+        captureFrame();
+    }
+    const uint64_t start_clock = satellites.clock;
+    const uint64_t end = start_clock + steps;
+    uint64_t burns = 0;
+    while (satellites.clock < end){
+        const uint64_t sample = std::min(end, start_clock + ((satellites.clock - start_clock) / every + 1) * every);
+        EventEffects effects;
+        scheduler.advance(satellites, sample, effects, [&](uint64_t to){
+            if (config.integrator == Integrator::Step){
+                while (satellites.clock < to){
+                    satellites.step();
                 }
             }
-            else if (bytes_received == 0)
-            {
-                // Sender closed the connection
-                std::cout << "Connection closed by peer";
-                break;
+            else {
+                satellites.propagateTo(to);
             }
+        });
+        burns += effects.burns;
+        // A pause stops short of the sample, the next pass carries on from there
+        recorder.record(satellites);
+        if (capture.capturing() && satellites.clock == sample){
+            captureFrame();
+        }
+    }
+    recorder.stop();
+    capture.stop();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 
-            // Process the received data
-            std::cout << "Received data: " << buf;
-            buf[bytes_received] = '\0';
+    std::cout << "Simulated " << satellites.size() << " satellites in " << P::NAME << " for " << steps << " steps in "
+              << seconds << " s: " << steps / seconds << " steps/s, "
+              << satellites.size() * static_cast<double>(steps) / seconds << " object-steps/s" << std::endl;
+    if (burns > 0){
+        std::cout << burns << " burns applied" << std::endl;
+    }
+    std::cout << "Ephemerides written to " << out_path << std::endl;
+    if (!capture_prefix.empty()){
+        std::cout << capture.frames() << " frames written to " << capture_prefix << "_*.ppm" << std::endl;
+    }
+    return 0;
+}
 
-            char* token = strtok(buf, ",");
-            int idx = 0;
-            while (token){
-                sat_params.push_back(atoi(token));
-                token = strtok(NULL, ",");
-                ++idx;
-            }
-            return sat_params;
+int main(int argc, char* argv[])
+{
+    // Command-line batch mode: no window, no GUI socket
+    const char* scenario_path = nullptr;
+    const char* batch_scenario = nullptr;
+    uint64_t batch_steps = 0;
+    uint64_t batch_every = 1;
+    std::string batch_out = "orbitsim_ephemeris.bin";
+    TrajectoryFormat batch_format = TrajectoryFormat::Binary;
+    std::string batch_capture;
+    bool batch_float = false;
+    for (int i = 1; i < argc; ++i){
+        const std::string arg = argv[i];
+        if (arg == "--scenario" && i + 1 < argc){
+            scenario_path = argv[++i];
         }
-        else
-        {
-            std::cerr << "No data available on socket, sticking to defaults";
+        else if (arg == "--batch" && i + 1 < argc){
+            batch_scenario = argv[++i];
+        }
+        else if (arg == "--steps" && i + 1 < argc){
+            batch_steps = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--every" && i + 1 < argc){
+            batch_every = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--out" && i + 1 < argc){
+            batch_out = argv[++i];
+        }
+        else if (arg == "--csv"){
+            batch_format = TrajectoryFormat::Csv;
+        }
+        else if (arg == "--float"){
+            batch_float = true;
+        }
+        else if (arg == "--capture" && i + 1 < argc){
+            batch_capture = argv[++i];
+        }
+        else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--scenario <file>] [--batch <scenario> --steps <n> [--every <k>] [--out <file>] [--csv]"
+                      << " [--float] [--capture <prefix>]]"
+                      << std::endl;
+            return 1;
         }
     }
+    if (batch_scenario){
+        return batch_float
+            ? runBatch<FloatPrecision>(batch_scenario, batch_steps, batch_out, batch_every, batch_format, batch_capture)
+            : runBatch<DoublePrecision>(batch_scenario, batch_steps, batch_out, batch_every, batch_format, batch_capture);
+    }
 
-    std::cout << "Returning default values";
-    return sat_params;
-}
-
+    SatelliteStore satellites; /*State of all simulated satellites*/
+    SimConfig config; /*Settings, overridden by the scenario*/
+    if (scenario_path && !loadScenario(scenario_path, satellites, config)){
+        return 1;
+    }
+    FrameLoop loop(satellites, config); /*State of the frames, the GUI-controlled satellite included*/
+    Camera default_camera = loop.camera; /*View restored by "0"*/
+    bool panning = false; /*Whether the view is being dragged*/
+    SnapshotWriter snapshot_writer; /*Saves snapshots in the background*/
+    SharedStatePublisher shared_state; /*Publishes the state to other processes, if the scenario asks*/
+    int warmup_frames = ALLOCATION_WARMUP_FRAMES; /*Frames left before allocations are an error*/
+    const char* socket_path = config.socket_path.c_str(); /*Path to the client socket*/
 
-int main()
-{
-    int angle=0; /*Angular position of satellite*/
-    int orbital_speed=2; /*Orbital speed of satellite*/
-    int delta_time=10; /*Frameskip time in ms*/
-    std::vector<int> sat_params; /*Array of satellite parameters*/
-    const char* socket_path = "/tmp/data_socket"; /*Path to the client socket*/
-    char buffer[1024]; /*Char buffer for data transmitted through socket*/
+    if (!config.shared_memory.empty() && shared_state.open(config.shared_memory, satellites.size())){
+        std::cout << "Publishing the simulation state to " << config.shared_memory << std::endl;
+    }
 
     // Create client socket and establish connection request
-    int client_socket = createSocket(socket_path);
+    loop.client_socket = createSocket(socket_path);
 
     // Initialize SDL and create a window and renderer for the window
     SDL_InitSubSystem(SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_TIMER);
@@ -239,53 +274,295 @@ int main()
         "Orbit simulator",
         SDL_WINDOWPOS_CENTERED,
         SDL_WINDOWPOS_CENTERED,
-        600, 600,
-        SDL_WINDOW_SHOWN | SDL_WINDOW_OPENGL
+        config.window_w, config.window_h,
+        SDL_WINDOW_SHOWN | SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI
     );
     SDL_Renderer* sim_renderer = SDL_CreateRenderer(sim_window, -1, SDL_RENDERER_ACCELERATED);
+
+    // With on-demand redraws the socket is watched from a thread that posts an event, so
+    // the loop can sleep on the event queue. createSocket() returns 0 or 1 when it failed
+    const Uint32 ipc_event = SDL_RegisterEvents(1); /*Posted when the GUI socket is readable*/
+    if (config.redraw_on_demand && loop.client_socket > 2 && ipc_event != static_cast<Uint32>(-1)){
+        loop.ipc_watcher.start(loop.client_socket, [ipc_event]{
+            SDL_Event ready = {};
+            ready.type = ipc_event;
+            SDL_PushEvent(&ready);
+        });
+    }
+
+    // Follows the size and pixel density of the renderer output. The camera works in output
+    // pixels, so the zoom is rescaled to keep the same view when the density changes, and the
+    // cached disks are rebuilt at the new size on their next draw
+    auto updateOutputSize = [&](){
+        int output_w = 0, output_h = 0, window_w = 0, window_h = 0;
+        SDL_GetRendererOutputSize(sim_renderer, &output_w, &output_h);
+        SDL_GetWindowSize(sim_window, &window_w, &window_h);
+        if (output_w <= 0 || output_h <= 0 || window_w <= 0){
+            return;
+        }
+        const float new_scale = static_cast<float>(output_w) / window_w;
+        for (Camera* view : {&loop.camera, &default_camera}){
+            view->km_per_px *= loop.dpi_scale / new_scale;
+            view->viewport_w = output_w;
+            view->viewport_h = output_h;
+        }
+        loop.dpi_scale = new_scale;
+        loop.earth_sprite.invalidate();
+        loop.satellite_sprite.invalidate();
+    };
+    updateOutputSize();
     
     // Get and send SDL window ID
     captureSDLWindowID(sim_window);
+    Tracer::instance().setThreadName("main");
 
     // SDL event loop
     while(true){
-        SDL_Delay(DELAY_MS);
-        
-        SDL_Event e;
+        // While nothing moves, sleep until an input event or a GUI message arrives
+        if (config.redraw_on_demand && loop.paused && !loop.redraw){
+            TRACE_SCOPE("idle");
+            SDL_WaitEvent(nullptr);
+        }
+        else {
+            TRACE_SCOPE("delay");
+            SDL_Delay(config.delay_ms);
+        }
+        TRACE_SCOPE("frame");
+        const uint64_t frame_allocations = allocationCount();
+        loop.beginFrame();
         
-        // Quit program if user clicks on "close"
-        if(SDL_PollEvent(&e)){
-            if (e.type == SDL_QUIT){
-                std::cout << "Quitting..." << std::endl;
-                break;
+        bool quit = false;
+        {
+            TRACE_SCOPE("events");
+            SDL_Event e;
+            while(SDL_PollEvent(&e)){
+                // Quit program if user clicks on "close"
+                if (e.type == SDL_QUIT){
+                    quit = true;
+                }
+                // "+" and "-" double and halve the time warp
+                else if (e.type == SDL_KEYDOWN){
+                    // Commands may set up buffers on first use, which is not steady state
+                    warmup_frames = ALLOCATION_WARMUP_FRAMES;
+                    if (e.key.keysym.sym == SDLK_PLUS || e.key.keysym.sym == SDLK_EQUALS){
+                        loop.time_warp = std::min(loop.time_warp * 2, MAX_TIME_WARP);
+                        std::cout << "Time warp: " << loop.time_warp << "x" << std::endl;
+                    }
+                    else if (e.key.keysym.sym == SDLK_MINUS){
+                        loop.time_warp = std::max<uint64_t>(loop.time_warp / 2, 1);
+                        std::cout << "Time warp: " << loop.time_warp << "x" << std::endl;
+                    }
+                    // Space pauses and resumes the simulation
+                    else if (e.key.keysym.sym == SDLK_SPACE){
+                        loop.paused = !loop.paused;
+                        std::cout << (loop.paused ? "Paused" : "Resumed") << std::endl;
+                    }
+                    // "0" resets the view
+                    else if (e.key.keysym.sym == SDLK_0){
+                        loop.camera = default_camera;
+                    }
+                    // F3 toggles the performance overlay
+                    else if (e.key.keysym.sym == SDLK_F3){
+                        loop.hud.enabled = !loop.hud.enabled;
+                    }
+                    // F4 starts recording a trace, pressing it again writes the trace out
+                    else if (e.key.keysym.sym == SDLK_F4){
+                        Tracer& tracer = Tracer::instance();
+                        if (tracer.recording()){
+                            tracer.stop();
+                            if (tracer.dump(TRACE_PATH)){
+                                std::cout << "Trace written to " << TRACE_PATH << std::endl;
+                            }
+                        }
+                        else {
+                            std::cout << "Recording trace..." << std::endl;
+                            tracer.start();
+                        }
+                    }
+                    // F6 starts recording the trajectories of all satellites, pressing it again stops
+                    else if (e.key.keysym.sym == SDLK_F6){
+                        if (loop.trajectory.recording()){
+                            loop.trajectory.stop();
+                            std::cout << "Trajectories written to " << TRAJECTORY_PATH << std::endl;
+                        }
+                        else if (loop.trajectory.start(TRAJECTORY_PATH, satellites, {}, TrajectoryFormat::Binary,
+                                                       TRAJECTORY_DECIMATION)){
+                            std::cout << "Recording trajectories..." << std::endl;
+                        }
+                    }
+                    // F7 switches between the SDL renderer and the CPU rasterizer
+                    else if (e.key.keysym.sym == SDLK_F7){
+                        loop.software_raster = !loop.software_raster;
+                        if (loop.software_raster){
+                            std::cout << "Software rasterizer, " << loop.workers.threads() << " threads" << std::endl;
+                        }
+                        else {
+                            std::cout << "SDL renderer" << std::endl;
+                        }
+                    }
+                    // F8 starts capturing every drawn frame, pressing it again stops
+                    else if (e.key.keysym.sym == SDLK_F8){
+                        if (loop.capture.capturing()){
+                            loop.capture.stop();
+                            std::cout << loop.capture.frames() << " frames written to " << CAPTURE_PREFIX << "_*.ppm"
+                                      << std::endl;
+                        }
+                        else if (loop.capture.start(CAPTURE_PREFIX, loop.camera.viewport_w, loop.camera.viewport_h)){
+                            std::cout << "Capturing frames..." << std::endl;
+                        }
+                    }
+                    // F5 saves a snapshot of the simulation, F9 restores it
+                    else if (e.key.keysym.sym == SDLK_F5){
+                        snapshot_writer.save(SNAPSHOT_PATH, satellites, loop.time_warp);
+                        loop.replay.clear();
+                    }
+                    else if (e.key.keysym.sym == SDLK_F9){
+                        SnapshotView snapshot;
+                        if (snapshot.open(SNAPSHOT_PATH) && snapshot.header().count > loop.sat_idx){
+                            // The recorded selection refers to the satellites being replaced
+                            if (loop.trajectory.recording()){
+                                loop.trajectory.stop();
+                                std::cout << "Trajectories written to " << TRAJECTORY_PATH << std::endl;
+                            }
+                            const uint64_t rewound_from = satellites.clock;
+                            snapshot.restore(satellites);
+                            loop.time_warp = snapshot.header().time_warp;
+                            // Replay the scenario's events from the restored step on. Those at the
+                            // step itself may already be in the snapshot: they set the same
+                            // elements again, and a pause there pauses again
+                            loop.scheduler.clear();
+                            for (const SimEvent& event : config.events){
+                                if (event.step >= satellites.clock){
+                                    loop.scheduler.schedule(event);
+                                }
+                            }
+                            // Fit the rewound window, up to the first event changing a satellite,
+                            // unless an earlier restore of this snapshot already did
+                            uint64_t replay_end = rewound_from;
+                            for (const SimEvent& event : config.events){
+                                if (event.step >= satellites.clock && event.kind != SimEvent::Pause &&
+                                    event.kind != SimEvent::Warp){
+                                    replay_end = std::min(replay_end, event.step);
+                                }
+                            }
+                            const bool replay_ready = loop.replay.size() == satellites.size() &&
+                                                      loop.replay.startStep() == satellites.clock &&
+                                                      loop.replay.covers(static_cast<double>(replay_end));
+                            if (!replay_ready && replay_end > satellites.clock &&
+                                static_cast<double>(replay_end - satellites.clock) * satellites.size() <=
+                                    REPLAY_MAX_OBJECT_STEPS){
+                                loop.replay.build(satellites, satellites.clock, replay_end, REPLAY_SEGMENT_STEPS,
+                                                  REPLAY_DEGREE, &loop.workers);
+                                std::cout << "Replaying " << replay_end - satellites.clock
+                                          << " steps from an ephemeris table, fit error "
+                                          << loop.replay.maxFitError() << " km" << std::endl;
+                            }
+                            // The GUI-controlled satellite continues from the restored state
+                            loop.sat_params.orbital_speed = satellites.rate[loop.sat_idx] / config.timestep;
+                            loop.sat_params.altitude = satellites.altitude[loop.sat_idx];
+                            loop.trail.clear();
+                            std::cout << "Restored " << satellites.size() << " satellites at step "
+                                      << satellites.clock << std::endl;
+                        }
+                    }
+                }
+                // Resizing or moving to a display of another density changes the output size
+                else if (e.type == SDL_WINDOWEVENT && (e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED ||
+                                                       e.window.event == SDL_WINDOWEVENT_DISPLAY_CHANGED)){
+                    warmup_frames = ALLOCATION_WARMUP_FRAMES;
+                    updateOutputSize();
+                    // An image sequence keeps one size
+                    if (loop.capture.capturing() && (loop.capture.width() != loop.camera.viewport_w ||
+                                                     loop.capture.height() != loop.camera.viewport_h)){
+                        loop.capture.stop();
+                        std::cout << "Output resized, " << loop.capture.frames() << " frames written to "
+                                  << CAPTURE_PREFIX << "_*.ppm" << std::endl;
+                    }
+                }
+                // Textures can be lost when the graphics device is reset
+                else if (e.type == SDL_RENDER_TARGETS_RESET || e.type == SDL_RENDER_DEVICE_RESET){
+                    loop.earth_sprite.invalidate();
+                    loop.satellite_sprite.invalidate();
+                    loop.raster.invalidate();
+                    loop.frame_cache.invalidate();
+                }
+                // Mouse wheel zooms around the cursor, left drag pans. Mouse positions are in
+                // window coordinates and the camera in output pixels. A new view can grow the
+                // cached Earth disk and the frame cache's lists, so it restarts the warm-up
+                else if (e.type == SDL_MOUSEWHEEL){
+                    warmup_frames = ALLOCATION_WARMUP_FRAMES;
+                    int mouse_x, mouse_y;
+                    SDL_GetMouseState(&mouse_x, &mouse_y);
+                    loop.camera.zoomAt(mouse_x * loop.dpi_scale, mouse_y * loop.dpi_scale, pow(ZOOM_STEP, e.wheel.y));
+                }
+                else if (e.type == SDL_MOUSEBUTTONDOWN && e.button.button == SDL_BUTTON_LEFT){
+                    panning = true;
+                }
+                else if (e.type == SDL_MOUSEBUTTONUP && e.button.button == SDL_BUTTON_LEFT){
+                    panning = false;
+                }
+                else if (e.type == SDL_MOUSEMOTION && panning){
+                    warmup_frames = ALLOCATION_WARMUP_FRAMES;
+                    loop.camera.pan(e.motion.xrel * loop.dpi_scale, e.motion.yrel * loop.dpi_scale);
+                }
+                else if (e.type == ipc_event){
+                    loop.ipc_ready = true;
+                }
+                // Anything but the socket wake-up and hovering may change what is shown
+                loop.redraw = loop.redraw || (e.type != ipc_event && (e.type != SDL_MOUSEMOTION || panning));
             }
         }
+        if (quit){
+            std::cout << "Quitting..." << std::endl;
+            break;
+        }
 
-        // Produce black window by default
-        SDL_SetRenderDrawColor(sim_renderer, 0, 0, 0, 255);
-        SDL_RenderClear(sim_renderer);
-        
-        // Draw Earth (just a blue blob for now, please don't lose your shit over this uwu)
-        drawFilledCircle(sim_renderer, 300, 300, 50, {0,0,255,255});
+        loop.profiler.lap(FramePhase::Events);
+
+        loop.readGui();
+        loop.simulate();
+
+        // Readers see every state that gets drawn
+        if (loop.redraw){
+            shared_state.publish(satellites);
+        }
+
+        // Nothing changed since the last present, the window keeps showing it
+        if (config.redraw_on_demand && !loop.redraw){
+            loop.profiler.discardFrame();
+            loop.frame_arena.reset();
+            continue;
+        }
+        loop.render(sim_renderer);
 
-        if (sat_params.empty())
         {
-            sat_params = {2,10};
+            TRACE_SCOPE("present");
+            SDL_RenderPresent(sim_renderer);
+            loop.profiler.lap(FramePhase::Present);
         }
-        // Get satellite orbital speed and altitude
-        sat_params = getSatelliteData(client_socket, buffer, sat_params);
-        // Update position of satellite
-        auto [sat_x, sat_y] = calculate_sat_coordinates(angle, sat_params[1]);
-        drawFilledCircle(sim_renderer, sat_x, sat_y, 10, {0,255,0,255});
-        angle += sat_params[0];
 
-        SDL_RenderPresent(sim_renderer);
+        // Everything allocated from the arena this frame is dead now
+        loop.frame_arena.reset();
+
+        // Once warmed up, a frame must not touch the heap
+        if (ALLOCATION_COUNTING){
+            if (warmup_frames > 0){
+                --warmup_frames;
+            }
+            else if (allocationCount() != frame_allocations){
+                std::cerr << "Steady-state frame performed " << allocationCount() - frame_allocations
+                          << " heap allocations" << std::endl;
+                abort();
+            }
+        }
     }
 
     // Cleanup at exit time
+    loop.ipc_watcher.stop();
+    loop.capture.stop();
     SDL_DestroyRenderer(sim_renderer);
     SDL_DestroyWindow(sim_window);
-    close(client_socket);
+    close(loop.client_socket);
     unlink(socket_path);
     SDL_Quit();
     return 0;
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "orbit.hpp"
+#include "snapshot.hpp"
+#include "trace.hpp"
+
+/*
+ * Shared-memory state layout (little-endian, read by orbitsim_shm.py, version 2 added the
+ * periapsis precession):
+ *
+ *   SharedStateHeader
+ *   padding to SNAPSHOT_ALIGN
+ *   one array per SatelliteStore column, in the order of forEachSnapshotArray(), each
+ *   starting at the offset recorded in the header and sized for `capacity` satellites
+ *
+ * `sequence` is a seqlock: it is odd while the simulation writes and even otherwise. A reader
+ * reads it, copies what it needs and reads it again; the copy is consistent if both reads
+ * returned the same even value. When the store outgrows the arrays, the segment is enlarged,
+ * `segment_size` and the offsets change, and readers must map the segment again.
+ */
+constexpr char SHARED_STATE_MAGIC[8] = {'O', 'R', 'B', 'S', 'H', 'M', '\0', '\0'};
+constexpr uint32_t SHARED_STATE_VERSION = 2;
+
+struct SharedStateHeader {
+    char magic[8];                      /*SHARED_STATE_MAGIC*/
+    uint32_t version;                   /*SHARED_STATE_VERSION*/
+    uint32_t array_count;               /*SNAPSHOT_ARRAYS*/
+    uint64_t segment_size;              /*Size of the whole segment (bytes)*/
+    uint64_t capacity;                  /*Satellites the arrays have room for*/
+    std::atomic<uint64_t> sequence;     /*Seqlock generation, odd during an update*/
+    uint64_t count;                     /*Number of satellites*/
+    uint64_t clock;                     /*Steps simulated*/
+    double body_radius;                 /*Radius of the central body (km)*/
+    uint64_t offsets[SNAPSHOT_ARRAYS];  /*Segment offset of each array (bytes)*/
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the seqlock must be lock-free to be shared");
+static_assert(std::is_standard_layout_v<SharedStateHeader>);
+
+/**
+ * @brief Publishes the satellite store to a POSIX shared-memory segment
+ *
+ * Analysis processes map the segment read-only and read the columns in place, see
+ * orbitsim_shm.py. publish() is a handful of memcpy calls inside the seqlock, so readers
+ * never block the simulation; they retry instead when an update overlapped their read.
+ */
+class SharedStatePublisher {
+public:
+    SharedStatePublisher() = default;
+    SharedStatePublisher(const SharedStatePublisher&) = delete;
+    SharedStatePublisher& operator=(const SharedStatePublisher&) = delete;
+
+    ~SharedStatePublisher(){
+        close();
+    }
+
+    bool active() const { return base != nullptr; }
+
+    /**
+     * @brief Creates the segment, replacing any left over by an earlier run
+     *
+     * @param name: Segment name, such as "/orbitsim"
+     * @param capacity: Satellites to make room for up front [size_t]
+     * @return [bool] True if the segment is ready
+     */
+    bool open(const std::string& name, size_t capacity){
+        close();
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd == -1){
+            perror("shm_open");
+            return false;
+        }
+        segment_name = name;
+        if (!reserve(std::max<size_t>(capacity, 1))){
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Copies the store into the segment
+     */
+    void publish(const SatelliteStore& store){
+        if (!base){
+            return;
+        }
+        TRACE_SCOPE("shared_state");
+        SharedStateHeader* header = headerPtr();
+        const uint64_t sequence = header->sequence.load(std::memory_order_relaxed);
+        header->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        if (store.size() > header->capacity && !reserve(store.size() + store.size() / 2)){
+            // Keep the segment consistent, readers see no satellites rather than torn ones
+            header = headerPtr();
+            header->count = 0;
+        }
+        else {
+            header = headerPtr();
+            header->count = store.size();
+            size_t a = 0;
+            forEachSnapshotArray(store, [&](const auto& column){
+                memcpy(static_cast<char*>(base) + header->offsets[a++], column.data(),
+                       column.size() * sizeof(column[0]));
+            });
+        }
+        header->clock = store.clock;
+        header->body_radius = store.body_radius;
+        header->sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Unmaps and removes the segment
+     */
+    void close(){
+        if (base){
+            munmap(base, mapped_size);
+            base = nullptr;
+            mapped_size = 0;
+        }
+        if (fd != -1){
+            ::close(fd);
+            fd = -1;
+            shm_unlink(segment_name.c_str());
+        }
+    }
+
+private:
+    SharedStateHeader* headerPtr() const {
+        return static_cast<SharedStateHeader*>(base);
+    }
+
+    /**
+     * @brief Sizes the segment for `capacity` satellites and lays out the arrays
+     *
+     * Called with the seqlock held (or before anyone can read), the sequence is carried over.
+     */
+    bool reserve(size_t capacity){
+        auto align = [](size_t offset){ return (offset + SNAPSHOT_ALIGN - 1) / SNAPSHOT_ALIGN * SNAPSHOT_ALIGN; };
+        uint64_t offsets[SNAPSHOT_ARRAYS];
+        size_t segment_size = align(sizeof(SharedStateHeader));
+        size_t a = 0;
+        const SatelliteStore columns; /*Only supplies the element types*/
+        forEachSnapshotArray(columns, [&](const auto& column){
+            offsets[a++] = segment_size;
+            segment_size = align(segment_size + capacity * sizeof(column[0]));
+        });
+
+        const uint64_t sequence = base ? headerPtr()->sequence.load(std::memory_order_relaxed) : 0;
+        if (ftruncate(fd, static_cast<off_t>(segment_size)) == -1){
+            perror("ftruncate");
+            return false;
+        }
+        void* mapped = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED){
+            perror("mmap");
+            return false;
+        }
+        if (base){
+            munmap(base, mapped_size);
+        }
+        base = mapped;
+        mapped_size = segment_size;
+        SharedStateHeader* header = new (base) SharedStateHeader;
+        memcpy(header->magic, SHARED_STATE_MAGIC, sizeof(header->magic));
+        header->version = SHARED_STATE_VERSION;
+        header->array_count = SNAPSHOT_ARRAYS;
+        header->segment_size = segment_size;
+        header->capacity = capacity;
+        header->sequence.store(sequence, std::memory_order_relaxed);
+        header->count = 0;
+        memcpy(header->offsets, offsets, sizeof(offsets));
+        return true;
+    }
+
+    int fd = -1;
+    void* base = nullptr;               /*Mapping of the whole segment*/
+    size_t mapped_size = 0;
+    std::string segment_name;
+};
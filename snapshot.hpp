@@ -0,0 +1,287 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "orbit.hpp"
+#include "trace.hpp"
+
+/*
+ * Snapshot file layout (little-endian, version 2 added the body radius, version 3 the
+ * periapsis precession):
+ *
+ *   SnapshotHeader
+ *   padding to SNAPSHOT_ALIGN
+ *   one array per SatelliteStore column, in the order of forEachSnapshotArray(), each
+ *   starting at the offset recorded in the header (a multiple of SNAPSHOT_ALIGN)
+ *
+ * Arrays are stored exactly as they sit in memory, so loading is a bounds check and a copy.
+ */
+constexpr char SNAPSHOT_MAGIC[8] = {'O', 'R', 'B', 'S', 'N', 'A', 'P', '\0'};
+constexpr uint32_t SNAPSHOT_VERSION = 3;
+constexpr size_t SNAPSHOT_ARRAYS = 11;     /*Columns of SatelliteStore stored in a snapshot*/
+constexpr size_t SNAPSHOT_ALIGN = 64;      /*Alignment of every array in the file (bytes)*/
+constexpr bool HOST_LITTLE_ENDIAN = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+struct SnapshotHeader {
+    char magic[8];                      /*SNAPSHOT_MAGIC*/
+    uint32_t version;                   /*SNAPSHOT_VERSION*/
+    uint32_t array_count;               /*SNAPSHOT_ARRAYS*/
+    uint64_t count;                     /*Number of satellites*/
+    uint64_t clock;                     /*Steps simulated*/
+    uint64_t time_warp;                 /*Steps simulated per frame*/
+    double body_radius;                 /*Radius of the central body (km)*/
+    uint64_t offsets[SNAPSHOT_ARRAYS];  /*File offset of each array (bytes)*/
+};
+
+/**
+ * @brief Calls a function on every column of a store, in file order
+ */
+template <typename Store, typename Fn>
+void forEachSnapshotArray(Store& store, Fn&& fn){
+    fn(store.id);
+    fn(store.angle);
+    fn(store.rate);
+    fn(store.altitude);
+    fn(store.eccentricity);
+    fn(store.periapsis);
+    fn(store.precession);
+    fn(store.x);
+    fn(store.y);
+    fn(store.prev_x);
+    fn(store.prev_y);
+}
+
+/**
+ * @brief Offset of each array in a snapshot of a store, returns the file size
+ */
+inline size_t snapshotLayout(const SatelliteStore& store, uint64_t offsets[SNAPSHOT_ARRAYS]){
+    auto align = [](size_t offset){ return (offset + SNAPSHOT_ALIGN - 1) / SNAPSHOT_ALIGN * SNAPSHOT_ALIGN; };
+    size_t offset = align(sizeof(SnapshotHeader));
+    size_t a = 0;
+    forEachSnapshotArray(store, [&](const auto& column){
+        offsets[a++] = offset;
+        offset = align(offset + column.size() * sizeof(column[0]));
+    });
+    return offset;
+}
+
+/**
+ * @brief Asynchronous snapshot writer
+ *
+ * save() copies the store into a file image on the calling thread, which is a handful of
+ * memcpy calls, and leaves the disk write to a background thread. The file is written under
+ * a temporary name and renamed into place, so a crash never leaves a truncated snapshot.
+ * Only one save runs at a time.
+ */
+class SnapshotWriter {
+public:
+    ~SnapshotWriter(){
+        if (worker.joinable()){
+            worker.join();
+        }
+    }
+
+    bool busy() const { return writing.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Starts saving a snapshot
+     *
+     * @param path: Output file path
+     * @param store: Satellite store to save
+     * @param time_warp: Time warp to restore with the snapshot [uint64_t]
+     * @return [bool] True if the save was started
+     */
+    bool save(const std::string& path, const SatelliteStore& store, uint64_t time_warp){
+        TRACE_SCOPE("snapshot_save");
+        if (!HOST_LITTLE_ENDIAN){
+            std::cerr << "Snapshots are little-endian, saving on this host is not supported" << std::endl;
+            return false;
+        }
+        if (busy()){
+            std::cerr << "A snapshot is still being written" << std::endl;
+            return false;
+        }
+        if (worker.joinable()){
+            worker.join();
+        }
+
+        SnapshotHeader header{};
+        memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = SNAPSHOT_VERSION;
+        header.array_count = SNAPSHOT_ARRAYS;
+        header.count = store.size();
+        header.clock = store.clock;
+        header.time_warp = time_warp;
+        header.body_radius = store.body_radius;
+        image.assign(snapshotLayout(store, header.offsets), 0);
+        memcpy(image.data(), &header, sizeof(header));
+        size_t a = 0;
+        forEachSnapshotArray(store, [&](const auto& column){
+            memcpy(image.data() + header.offsets[a++], column.data(), column.size() * sizeof(column[0]));
+        });
+
+        writing.store(true, std::memory_order_release);
+        worker = std::thread([this, path]{
+            Tracer::instance().setThreadName("snapshot");
+            write(path);
+            writing.store(false, std::memory_order_release);
+        });
+        return true;
+    }
+
+private:
+    void write(const std::string& path){
+        TRACE_SCOPE("snapshot_write");
+        const std::string tmp_path = path + ".tmp";
+        FILE* out = fopen(tmp_path.c_str(), "wb");
+        if (!out){
+            perror("fopen");
+            return;
+        }
+        const bool written = fwrite(image.data(), 1, image.size(), out) == image.size();
+        if (fclose(out) != 0 || !written){
+            std::cerr << "Failed to write snapshot " << path << std::endl;
+            unlink(tmp_path.c_str());
+            return;
+        }
+        if (rename(tmp_path.c_str(), path.c_str()) != 0){
+            perror("rename");
+            return;
+        }
+        std::cout << "Snapshot written to " << path << std::endl;
+    }
+
+    std::vector<unsigned char> image;   /*File image of the save in progress*/
+    std::thread worker;
+    std::atomic<bool> writing{false};
+};
+
+/**
+ * @brief Memory-mapped snapshot file
+ *
+ * Maps the file read-only and validates the header and the bounds of every array, after
+ * which the arrays are read in place.
+ */
+class SnapshotView {
+public:
+    SnapshotView() = default;
+    SnapshotView(const SnapshotView&) = delete;
+    SnapshotView& operator=(const SnapshotView&) = delete;
+
+    ~SnapshotView(){
+        close();
+    }
+
+    /**
+     * @brief Maps and validates a snapshot
+     *
+     * @param path: Snapshot file path
+     * @return [bool] True if the file is a readable snapshot
+     */
+    bool open(const char* path){
+        close();
+        if (!HOST_LITTLE_ENDIAN){
+            std::cerr << "Snapshots are little-endian, loading on this host is not supported" << std::endl;
+            return false;
+        }
+        int fd = ::open(path, O_RDONLY);
+        if (fd == -1){
+            perror("open");
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) == -1 || static_cast<size_t>(info.st_size) < sizeof(SnapshotHeader)){
+            std::cerr << path << " is not a snapshot" << std::endl;
+            ::close(fd);
+            return false;
+        }
+        length = info.st_size;
+        // Prefault the whole file, restore() reads all of it anyway
+        void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED){
+            perror("mmap");
+            return false;
+        }
+        data = static_cast<const unsigned char*>(mapped);
+        if (!validate()){
+            std::cerr << path << " is not a compatible snapshot" << std::endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close(){
+        if (data){
+            munmap(const_cast<unsigned char*>(data), length);
+            data = nullptr;
+        }
+    }
+
+    const SnapshotHeader& header() const {
+        return *reinterpret_cast<const SnapshotHeader*>(data);
+    }
+
+    /**
+     * @brief Start of an array in the mapping
+     *
+     * @param index: Position of the array in forEachSnapshotArray() order [size_t]
+     */
+    const void* array(size_t index) const {
+        return data + header().offsets[index];
+    }
+
+    /**
+     * @brief Copies the snapshot into a store, replacing its contents
+     */
+    void restore(SatelliteStore& store) const {
+        TRACE_SCOPE("snapshot_restore");
+        const size_t n = header().count;
+        size_t a = 0;
+        forEachSnapshotArray(store, [&](auto& column){
+            using T = std::decay_t<decltype(column[0])>;
+            const T* source = static_cast<const T*>(array(a++));
+            column.assign(source, source + n);
+        });
+        store.clock = header().clock;
+        store.body_radius = header().body_radius;
+        store.invalidateGroups();
+    }
+
+private:
+    bool validate() const {
+        const SnapshotHeader& h = header();
+        if (memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic)) != 0 || h.version != SNAPSHOT_VERSION ||
+            h.array_count != SNAPSHOT_ARRAYS){
+            return false;
+        }
+        // Every array must be aligned and fit inside the file
+        SatelliteStore shape;
+        size_t a = 0;
+        bool in_bounds = true;
+        forEachSnapshotArray(shape, [&](const auto& column){
+            const uint64_t offset = h.offsets[a++];
+            const uint64_t bytes = h.count * sizeof(column[0]);
+            in_bounds = in_bounds && offset % SNAPSHOT_ALIGN == 0 && h.count <= length / sizeof(column[0])
+                     && offset <= length && bytes <= length - offset;
+        });
+        return in_bounds;
+    }
+
+    const unsigned char* data = nullptr;
+    size_t length = 0;
+};
@@ -0,0 +1,444 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "aa_raster.hpp"
+#include "arena.hpp"
+#include "lod.hpp"
+#include "render.hpp"
+#include "trace.hpp"
+#include "worker_pool.hpp"
+
+/**
+ * @brief Packs a colour into an ARGB8888 pixel
+ */
+inline uint32_t packArgb(SDL_Color colour){
+    return static_cast<uint32_t>(colour.a) << 24 | static_cast<uint32_t>(colour.r) << 16
+         | static_cast<uint32_t>(colour.g) << 8 | colour.b;
+}
+
+/**
+ * @brief CPU rasterizer drawing straight into a streaming texture
+ *
+ * Drawing calls only record primitives; finish() bins them into square tiles, locks the
+ * streaming texture and has the worker pool rasterize the tiles in parallel directly into the
+ * texture memory, then copies the texture to the renderer once. Every pixel belongs to exactly
+ * one tile, so the tiles need no synchronisation, and a tile draws its primitives in the order
+ * they were recorded, so the result matches drawing them one after the other. The cost
+ * depends on the covered pixels and the number of cores rather than on renderer calls.
+ * Disks, rings and lines are anti-aliased, see aa_raster.hpp. rasterize() draws into plain
+ * memory instead, for headless rendering.
+ *
+ * The tile lists are counting-sorted into the calling thread's frame arena and released when
+ * the frame is rasterized, so binning does not allocate however the primitives spread.
+ */
+class SoftwareRaster {
+public:
+    static constexpr int TILE = 64;     /*Tile side (px)*/
+
+    SoftwareRaster() = default;
+    SoftwareRaster(const SoftwareRaster&) = delete;
+    SoftwareRaster& operator=(const SoftwareRaster&) = delete;
+
+    ~SoftwareRaster(){
+        invalidate();
+    }
+
+    /**
+     * @brief Drops the texture, for example after a renderer device reset
+     */
+    void invalidate(){
+        if (texture){
+            SDL_DestroyTexture(texture);
+            texture = nullptr;
+        }
+    }
+
+    /**
+     * @brief Starts a frame
+     *
+     * @param width: Output width (px) [int]
+     * @param height: Output height (px) [int]
+     * @param background: Colour every pixel starts with [SDL_Color]
+     */
+    void begin(int width, int height, SDL_Color background){
+        if (width != frame_w || height != frame_h){
+            invalidate();
+            frame_w = width;
+            frame_h = height;
+            tiles_x = (width + TILE - 1) / TILE;
+            tiles_y = (height + TILE - 1) / TILE;
+        }
+        clear_colour = packArgb(background);
+        primitives.clear();
+    }
+
+    /**
+     * @brief Records an anti-aliased filled disk
+     */
+    void disk(float centre_x, float centre_y, float radius, SDL_Color colour){
+        primitives.push_back({Primitive::Disk, centre_x, centre_y, radius, 0, 0, packArgb(colour)});
+    }
+
+    /**
+     * @brief Records an anti-aliased circle outline
+     *
+     * @param width: Stroke width (px) [float]
+     */
+    void ring(float centre_x, float centre_y, float radius, float width, SDL_Color colour){
+        primitives.push_back({Primitive::Ring, centre_x, centre_y, radius, 0.5f * width, 0, packArgb(colour)});
+    }
+
+    /**
+     * @brief Records an anti-aliased polyline through count points
+     *
+     * @param width: Stroke width (px) [float]
+     */
+    void lines(const SDL_FPoint* pts, size_t count, float width, SDL_Color colour){
+        const uint32_t pixel = packArgb(colour);
+        for (size_t i = 1; i < count; ++i){
+            primitives.push_back({Primitive::Line, pts[i - 1].x, pts[i - 1].y, pts[i].x, pts[i].y, width, pixel});
+        }
+    }
+
+    /**
+     * @brief Records single-pixel points
+     */
+    void points(const SDL_FPoint* pts, size_t count, SDL_Color colour){
+        const uint32_t pixel = packArgb(colour);
+        for (size_t i = 0; i < count; ++i){
+            primitives.push_back({Primitive::Point, pts[i].x, pts[i].y, 0, 0, 0, pixel});
+        }
+    }
+
+    /**
+     * @brief Records filled rectangles
+     */
+    void rects(const SDL_Rect* rs, size_t count, SDL_Color colour){
+        const uint32_t pixel = packArgb(colour);
+        for (size_t i = 0; i < count; ++i){
+            primitives.push_back({Primitive::Rect, static_cast<float>(rs[i].x), static_cast<float>(rs[i].y),
+                                  static_cast<float>(rs[i].w), static_cast<float>(rs[i].h), 0, pixel});
+        }
+    }
+
+    /**
+     * @brief Rasterizes the recorded primitives and copies the result to the renderer
+     *
+     * @param renderer: A reference to the SDL renderer
+     * @param pool: Workers that rasterize the tiles
+     * @param capture: Buffer of width * height pixels that also receives the frame, or nullptr
+     * @return [bool] False if the streaming texture is unavailable and nothing was drawn
+     */
+    bool finish(SDL_Renderer* renderer, WorkerPool& pool, uint32_t* capture = nullptr){
+        TRACE_SCOPE("software_raster");
+        if (frame_w <= 0 || frame_h <= 0){
+            return false;
+        }
+        if (!texture){
+            texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+                                        frame_w, frame_h);
+            if (!texture){
+                return false;
+            }
+        }
+
+        void* locked;
+        int pitch;
+        if (SDL_LockTexture(texture, nullptr, &locked, &pitch) != 0){
+            return false;
+        }
+        rasterize(locked, pitch, pool);
+        // The frame is still in CPU memory, copying it is far cheaper than reading it back
+        if (capture){
+            for (int y = 0; y < frame_h; ++y){
+                std::copy(row(y), row(y) + frame_w, capture + static_cast<size_t>(y) * frame_w);
+            }
+        }
+        SDL_UnlockTexture(texture);
+
+        SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+        ++render_stats.draw_calls;
+        return true;
+    }
+
+    /**
+     * @brief Rasterizes the recorded primitives into memory, without a renderer
+     *
+     * @param target: First pixel of an ARGB8888 frame of the size given to begin()
+     * @param pitch: Bytes between rows [int]
+     * @param pool: Workers that rasterize the tiles
+     */
+    void rasterize(void* target, int pitch, WorkerPool& pool){
+        FrameArena& arena = threadArena();
+        const FrameArena::Marker scratch_start = arena.mark();
+        binPrimitives(arena);
+        pixels = static_cast<unsigned char*>(target);
+        row_pitch = pitch;
+        pool.parallelFor(static_cast<size_t>(tiles_x) * tiles_y, [&](size_t tile){ rasterizeTile(tile); });
+        arena.rewind(scratch_start);
+    }
+
+private:
+    struct Primitive {
+        enum Kind : uint8_t { Disk, Ring, Line, Point, Rect } kind;
+        /*Disk: centre x, centre y, radius. Ring: centre x, centre y, radius, half width.
+          Line: x0, y0, x1, y1, width. Point: x, y. Rect: x, y, w, h*/
+        float a, b, c, d, e;
+        uint32_t pixel;
+    };
+
+    /**
+     * @brief Pixel bounds of a primitive, inclusive, unclipped
+     */
+    static void bounds(const Primitive& p, int& x0, int& y0, int& x1, int& y1){
+        switch (p.kind){
+            case Primitive::Disk:
+            case Primitive::Ring: {
+                // The anti-aliased edge reaches half a pixel past the outline
+                const float extent = p.c + (p.kind == Primitive::Ring ? p.d : 0.0f) + 0.5f;
+                x0 = static_cast<int>(std::floor(p.a - extent));
+                y0 = static_cast<int>(std::floor(p.b - extent));
+                x1 = static_cast<int>(std::ceil(p.a + extent));
+                y1 = static_cast<int>(std::ceil(p.b + extent));
+                break;
+            }
+            case Primitive::Line:
+                AaLine(p.a, p.b, p.c, p.d, p.e).bounds(x0, y0, x1, y1);
+                break;
+            case Primitive::Point:
+                x0 = x1 = static_cast<int>(std::floor(p.a));
+                y0 = y1 = static_cast<int>(std::floor(p.b));
+                break;
+            case Primitive::Rect:
+                x0 = static_cast<int>(p.a);
+                y0 = static_cast<int>(p.b);
+                x1 = x0 + static_cast<int>(p.c) - 1;
+                y1 = y0 + static_cast<int>(p.d) - 1;
+                break;
+        }
+    }
+
+    /**
+     * @brief Calls fn(tile) for every tile a primitive overlaps
+     */
+    template <typename Fn>
+    void forEachTile(const Primitive& p, Fn&& fn) const {
+        int x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+        bounds(p, x0, y0, x1, y1);
+        x0 = std::max(x0, 0);
+        y0 = std::max(y0, 0);
+        x1 = std::min(x1, frame_w - 1);
+        y1 = std::min(y1, frame_h - 1);
+        if (x0 > x1 || y0 > y1){
+            return;
+        }
+        for (int ty = y0 / TILE; ty <= y1 / TILE; ++ty){
+            for (int tx = x0 / TILE; tx <= x1 / TILE; ++tx){
+                fn(static_cast<size_t>(ty) * tiles_x + tx);
+            }
+        }
+    }
+
+    /**
+     * @brief Lists, for every tile, the primitives overlapping it in recording order
+     *
+     * Counting sort: one pass counts the primitives of each tile, the next one writes their
+     * indices, so the lists of all tiles share one arena allocation.
+     */
+    void binPrimitives(FrameArena& arena){
+        const size_t n_tiles = static_cast<size_t>(tiles_x) * tiles_y;
+        uint32_t* start = arena.alloc<uint32_t>(n_tiles + 1);
+        std::fill(start, start + n_tiles + 1, 0u);
+        for (const Primitive& p : primitives){
+            forEachTile(p, [&](size_t tile){ ++start[tile + 1]; });
+        }
+        for (size_t tile = 0; tile < n_tiles; ++tile){
+            start[tile + 1] += start[tile];
+        }
+        uint32_t* fill = arena.alloc<uint32_t>(n_tiles);
+        std::copy(start, start + n_tiles, fill);
+        uint32_t* indices = arena.alloc<uint32_t>(start[n_tiles]);
+        for (size_t i = 0; i < primitives.size(); ++i){
+            forEachTile(primitives[i], [&](size_t tile){ indices[fill[tile]++] = static_cast<uint32_t>(i); });
+        }
+        bin_start = start;
+        bin_indices = indices;
+    }
+
+    void rasterizeTile(size_t tile){
+        const int tx0 = static_cast<int>(tile % tiles_x) * TILE;
+        const int ty0 = static_cast<int>(tile / tiles_x) * TILE;
+        const int tx1 = std::min(tx0 + TILE, frame_w) - 1;
+        const int ty1 = std::min(ty0 + TILE, frame_h) - 1;
+        for (int y = ty0; y <= ty1; ++y){
+            std::fill(row(y) + tx0, row(y) + tx1 + 1, clear_colour);
+        }
+        for (uint32_t b = bin_start[tile]; b < bin_start[tile + 1]; ++b){
+            const Primitive& p = primitives[bin_indices[b]];
+            if (p.kind == Primitive::Point){
+                row(static_cast<int>(std::floor(p.b)))[static_cast<int>(std::floor(p.a))] = p.pixel;
+            }
+            else if (p.kind == Primitive::Rect){
+                int x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+                bounds(p, x0, y0, x1, y1);
+                x0 = std::max(x0, tx0);
+                x1 = std::min(x1, tx1);
+                for (int y = std::max(y0, ty0); y <= std::min(y1, ty1); ++y){
+                    std::fill(row(y) + x0, row(y) + x1 + 1, p.pixel);
+                }
+            }
+            else if (p.kind == Primitive::Disk){
+                rasterizeDisk(p, tx0, ty0, tx1, ty1);
+            }
+            else if (p.kind == Primitive::Ring){
+                rasterizeRing(p, tx0, ty0, tx1, ty1);
+            }
+            else {
+                const AaLine line(p.a, p.b, p.c, p.d, p.e);
+                int x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+                line.bounds(x0, y0, x1, y1);
+                x0 = std::max(x0, tx0);
+                x1 = std::min(x1, tx1);
+                for (int y = std::max(y0, ty0); y <= std::min(y1, ty1); ++y){
+                    blendShapeRow(row(y), x0, x1, y, line, opaque(p.pixel), opacity(p.pixel));
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Fills the fully covered middle of each row and blends only the edges
+     */
+    void rasterizeDisk(const Primitive& p, int tx0, int ty0, int tx1, int ty1){
+        const AaDisk disk{p.a, p.b, p.c};
+        const float outer = p.c + 0.5f;     /*Pixel centres beyond are not covered*/
+        const float inner = p.c - 0.5f;     /*Pixel centres within are fully covered*/
+        const bool solid = (p.pixel >> 24) == 0xFF;
+        const int y_first = std::max(ty0, static_cast<int>(std::floor(p.b - outer)));
+        const int y_last = std::min(ty1, static_cast<int>(std::ceil(p.b + outer)));
+        for (int y = y_first; y <= y_last; ++y){
+            const float dy = y + 0.5f - p.b;
+            if (std::fabs(dy) >= outer){
+                continue;
+            }
+            const float half = std::sqrt(outer * outer - dy * dy);
+            const int x0 = std::max(tx0, static_cast<int>(std::floor(p.a - half)));
+            const int x1 = std::min(tx1, static_cast<int>(std::floor(p.a + half)));
+            if (x0 > x1){
+                continue;
+            }
+            int fill0 = x1 + 1, fill1 = x1;
+            if (solid && std::fabs(dy) < inner){
+                const float core = std::sqrt(inner * inner - dy * dy);
+                fill0 = std::max(x0, static_cast<int>(std::ceil(p.a - core - 0.5f)));
+                fill1 = std::min(x1, static_cast<int>(std::floor(p.a + core - 0.5f)));
+            }
+            if (fill0 <= fill1){
+                blendShapeRow(row(y), x0, fill0 - 1, y, disk, p.pixel, 1.0f);
+                std::fill(row(y) + fill0, row(y) + fill1 + 1, p.pixel);
+                blendShapeRow(row(y), fill1 + 1, x1, y, disk, p.pixel, 1.0f);
+            }
+            else {
+                blendShapeRow(row(y), x0, x1, y, disk, opaque(p.pixel), opacity(p.pixel));
+            }
+        }
+    }
+
+    /**
+     * @brief Blends the two arcs of the ring crossing each row, skipping the hole
+     */
+    void rasterizeRing(const Primitive& p, int tx0, int ty0, int tx1, int ty1){
+        const AaRing ring{p.a, p.b, p.c, p.d};
+        const float outer = p.c + p.d + 0.5f;
+        const float inner = p.c - p.d - 0.5f;
+        const uint32_t colour = opaque(p.pixel);
+        const float alpha = opacity(p.pixel);
+        const int y_first = std::max(ty0, static_cast<int>(std::floor(p.b - outer)));
+        const int y_last = std::min(ty1, static_cast<int>(std::ceil(p.b + outer)));
+        for (int y = y_first; y <= y_last; ++y){
+            const float dy = y + 0.5f - p.b;
+            if (std::fabs(dy) >= outer){
+                continue;
+            }
+            const float half = std::sqrt(outer * outer - dy * dy);
+            const float hole = inner > 0 && std::fabs(dy) < inner ? std::sqrt(inner * inner - dy * dy) : 0.0f;
+            // Left arc, then right arc; they merge when the row misses the hole
+            const int left0 = std::max(tx0, static_cast<int>(std::floor(p.a - half)));
+            const int left1 = std::min(tx1, static_cast<int>(std::floor(p.a - hole)));
+            const int right0 = std::max({tx0, static_cast<int>(std::floor(p.a + hole)), left1 + 1});
+            const int right1 = std::min(tx1, static_cast<int>(std::floor(p.a + half)));
+            blendShapeRow(row(y), left0, left1, y, ring, colour, alpha);
+            blendShapeRow(row(y), right0, right1, y, ring, colour, alpha);
+        }
+    }
+
+    /**
+     * @brief The pixel with full alpha, blending applies the alpha as coverage instead
+     */
+    static uint32_t opaque(uint32_t pixel){
+        return pixel | 0xFF000000u;
+    }
+
+    static float opacity(uint32_t pixel){
+        return (pixel >> 24) / 255.0f;
+    }
+
+    uint32_t* row(int y) const {
+        return reinterpret_cast<uint32_t*>(pixels + static_cast<size_t>(y) * row_pitch);
+    }
+
+    SDL_Texture* texture = nullptr;
+    int frame_w = 0, frame_h = 0;
+    int tiles_x = 0, tiles_y = 0;
+    uint32_t clear_colour = 0;
+    std::vector<Primitive> primitives;          /*Recorded this frame*/
+    const uint32_t* bin_start = nullptr;        /*First entry of each tile in bin_indices, during rasterize()*/
+    const uint32_t* bin_indices = nullptr;      /*Primitive indices of every tile, tile after tile*/
+    unsigned char* pixels = nullptr;            /*Frame memory during rasterize()*/
+    int row_pitch = 0;
+};
+
+/**
+ * @brief Records the visible satellites into the software rasterizer
+ *
+ * Software counterpart of drawSatellites(), drawing the same levels of detail.
+ *
+ * @param raster: Software rasterizer of the frame
+ * @param visible: Screen positions of the satellites inside the viewport (px)
+ * @param mode: Level of detail to draw at [LodMode]
+ * @param radius: The radius of a satellite disk (px) [float]
+ * @param density: Density grid reused between frames
+ * @param viewport: The viewport rectangle [SDL_Rect]
+ * @param colour: The RGBA-format colour of the satellites [SDL_colour]
+ */
+inline void drawSatellitesSoftware(SoftwareRaster& raster, const ArenaArray<SDL_FPoint>& visible, LodMode mode,
+                                   float radius, DensityGrid& density, const SDL_Rect& viewport, SDL_Color colour){
+    if (mode == LodMode::Disk){
+        for (const SDL_FPoint& sat : visible){
+            raster.disk(sat.x, sat.y, radius, colour);
+        }
+    }
+    else if (mode == LodMode::Point){
+        raster.points(visible.data(), visible.size(), colour);
+    }
+    else {
+        density.reset(viewport.w, viewport.h);
+        for (const SDL_FPoint& sat : visible){
+            density.add(sat.x, sat.y);
+        }
+        const auto& levels = density.build();
+        for (int level = 0; level < DensityGrid::LEVELS; ++level){
+            const int scale = 64 + (255 - 64) * (level + 1) / DensityGrid::LEVELS;
+            const SDL_Color shade = {static_cast<Uint8>(colour.r * scale / 255), static_cast<Uint8>(colour.g * scale / 255),
+                                     static_cast<Uint8>(colour.b * scale / 255), colour.a};
+            raster.rects(levels[level].data(), levels[level].size(), shade);
+        }
+    }
+}
@@ -0,0 +1,231 @@
+// Steady-state allocation test of the frame loop
+//
+// Build: g++ -O2 -std=c++17 test_alloc_steady_state.cpp -o test_alloc_steady_state -lSDL2 -pthread
+// Usage: ./test_alloc_steady_state [--frames <n>]
+//
+// Runs the frames of the main loop headless, through the same FrameLoop as the window: slider
+// messages read from a socket every frame, scheduled events, stepping and closed-form jumps,
+// conjunction screening, the trail, every level of detail through both the SDL renderer (on
+// a software renderer, with the frame cache) and the CPU rasterizer, and the performance
+// overlay. After a warm-up, any heap allocation made by the loop's thread fails the test; the
+// rasterizer's worker threads and SDL's own allocations are not counted. Exits with status 0
+// on success and 1 on failure.
+
+#define ORBITSIM_COUNT_ALLOCATIONS
+
+#include <SDL2/SDL.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "alloc_counter.hpp"
+#include "frame_loop.hpp"
+
+constexpr int WARMUP_FRAMES = 120;          /*Frames allowed to allocate, as in the main loop*/
+constexpr int DEFAULT_FRAMES = 2000;        /*Frames checked after the warm-up*/
+constexpr size_t SATELLITES = 3000;         /*Satellites besides the GUI-controlled one*/
+constexpr uint64_t TIME_WARP = 4;           /*Steps per frame, stepped*/
+constexpr uint64_t JUMP_EVERY = 50;         /*Frames between closed-form jumps*/
+constexpr uint64_t JUMP_STEPS = 600;        /*Steps covered by a jump*/
+constexpr int ZOOM_EVERY = 16;              /*Frames between switches of the zoom level*/
+constexpr int LOD_EVERY = 8;                /*Frames between switches of the level of detail*/
+constexpr int RASTER_EVERY = 24;            /*Frames between switches of the CPU rasterizer*/
+constexpr int SLIDER_MESSAGES = 16;         /*Distinct slider updates the GUI side cycles through*/
+
+/**
+ * @brief Stream buffer discarding everything written to it
+ */
+struct NullBuffer : std::streambuf {
+    int overflow(int c) override { return c; }
+};
+
+/**
+ * @brief Fills a store with satellites of every propagator
+ *
+ * @param store: Store to fill
+ * @param count: Number of satellites [size_t]
+ */
+void populateStore(SatelliteStore& store, size_t count){
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (size_t i = 0; i < count; ++i){
+        const double eccentricity = i % 3 == 0 ? 0.0 : 0.4 * unit(rng);
+        const double precession = i % 3 == 2 ? 0.02 * unit(rng) : 0.0;
+        store.add(60 + 400 * unit(rng), 0.2 + 3 * unit(rng), 360 * unit(rng), eccentricity, 360 * unit(rng),
+                  precession);
+    }
+}
+
+/**
+ * @brief Schedules events of every kind over the run, some of them moving satellites between propagators
+ *
+ * @param scheduler: Scheduler to fill
+ * @param count: Number of satellites that events may target [size_t]
+ * @param last_step: Last step the run reaches [uint64_t]
+ */
+void scheduleEvents(EventScheduler& scheduler, size_t count, uint64_t last_step){
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<uint64_t> step(1, last_step);
+    std::uniform_int_distribution<uint32_t> satellite(0, static_cast<uint32_t>(count - 1));
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const double keep = std::numeric_limits<double>::quiet_NaN();
+    for (int i = 0; i < 400; ++i){
+        SimEvent event{};
+        event.step = step(rng);
+        event.satellite = satellite(rng);
+        switch (i % 4){
+            case 0:
+                event.kind = SimEvent::Burn;
+                event.value[0] = 60 + 400 * unit(rng);
+                event.value[1] = 0.2 + 3 * unit(rng);
+                event.value[2] = i % 8 == 0 ? 0.4 * unit(rng) : keep;
+                break;
+            case 1:
+                event.kind = SimEvent::Rate;
+                event.value[0] = 0.2 + 3 * unit(rng);
+                break;
+            case 2:
+                event.kind = SimEvent::Altitude;
+                event.value[0] = 60 + 400 * unit(rng);
+                break;
+            default:
+                event.kind = SimEvent::Warp;
+                event.value[0] = TIME_WARP;
+                break;
+        }
+        scheduler.schedule(event);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int frames = DEFAULT_FRAMES;
+    for (int i = 1; i < argc; ++i){
+        const std::string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc){
+            frames = std::max(1, atoi(argv[++i]));
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--frames <n>]" << std::endl;
+            return 1;
+        }
+    }
+
+    SatelliteStore satellites;
+    populateStore(satellites, SATELLITES);
+    SimConfig config;
+    config.window_w = 1280;
+    config.window_h = 720;
+    config.km_per_px = 40;
+    config.gui_speed = 1;
+    config.gui_altitude = 200;
+    config.lod_frame_budget_ms = 1e9;   /*Levels of detail follow the limits set below only*/
+    FrameLoop loop(satellites, config);
+    loop.hud.enabled = true;
+    const int total_frames = WARMUP_FRAMES + frames;
+    scheduleEvents(loop.scheduler, satellites.size(),
+                   total_frames * TIME_WARP + (total_frames / JUMP_EVERY + 1) * JUMP_STEPS);
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, config.window_w, config.window_h, 32,
+                                                          SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (!renderer){
+        std::cerr << "Software renderer unavailable: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+
+    // The GUI end of the socket, with the slider updates it sends formatted up front
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1){
+        perror("socketpair");
+        return 1;
+    }
+    loop.client_socket = fds[0];
+    std::vector<std::string> messages;
+    for (int i = 0; i < SLIDER_MESSAGES; ++i){
+        messages.push_back("speed=" + std::to_string(1 + i % 5) + "\naltitude=" + std::to_string(150 + 10 * i) + "\n");
+    }
+
+    const Camera wide = loop.camera;
+    Camera zoomed = wide;
+    zoomed.zoomAt(640, 360, 8.0);
+
+    // The frames report conjunctions, burns and time warps; formatted as usual, but discarded
+    NullBuffer discard;
+    std::streambuf* stdout_buffer = std::cout.rdbuf(&discard);
+
+    int failed_frames = 0;
+    uint64_t allocations = 0;
+    for (int f = 0; f < total_frames; ++f){
+        const uint64_t frame_allocations = allocationCount();
+        loop.beginFrame();
+
+        // Input: a slider update, the zoom level, stepped frames with a closed-form jump now
+        // and then, the level of detail and the rasterizer
+        const std::string& message = messages[f % SLIDER_MESSAGES];
+        if (write(fds[1], message.data(), message.size()) < 0){
+            perror("write");
+            return 1;
+        }
+        loop.camera = (f / ZOOM_EVERY) % 2 ? zoomed : wide;
+        loop.time_warp = f % JUMP_EVERY == 0 ? JUMP_STEPS : TIME_WARP;
+        const LodMode mode = static_cast<LodMode>((f / LOD_EVERY) % 3);
+        loop.lod.disk_limit = mode == LodMode::Disk ? satellites.size() : 0;
+        loop.lod.point_limit = mode == LodMode::Density ? 0 : satellites.size();
+        loop.software_raster = (f / RASTER_EVERY) % 2;
+        loop.profiler.lap(FramePhase::Events);
+
+        loop.readGui();
+        loop.simulate();
+        loop.render(renderer);
+        SDL_RenderPresent(renderer);
+        loop.profiler.lap(FramePhase::Present);
+        loop.frame_arena.reset();
+
+        const uint64_t frame_total = allocationCount() - frame_allocations;
+        if (f >= WARMUP_FRAMES && frame_total > 0){
+            if (failed_frames < 10){
+                std::cerr << "Frame " << f << " (step " << satellites.clock << ", " << lodModeName(loop.lod.mode)
+                          << (loop.software_raster ? ", CPU rasterizer" : ", SDL renderer") << "): "
+                          << frame_total << " heap allocations" << std::endl;
+            }
+            ++failed_frames;
+            allocations += frame_total;
+        }
+    }
+
+    std::cout.rdbuf(stdout_buffer);
+
+    const int expected_altitude = 150 + 10 * ((total_frames - 1) % SLIDER_MESSAGES);
+    const bool applied = loop.sat_params.altitude == expected_altitude &&
+                         satellites.altitude[loop.sat_idx] == expected_altitude;
+    close(fds[0]);
+    close(fds[1]);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+
+    if (!applied){
+        std::cerr << "FAILED: the GUI-controlled satellite is at " << satellites.altitude[loop.sat_idx]
+                  << " km, the last slider update asked for " << expected_altitude << " km" << std::endl;
+        return 1;
+    }
+    if (failed_frames > 0){
+        std::cerr << "FAILED: " << failed_frames << " of " << frames << " steady-state frames allocated, "
+                  << allocations << " allocations in total" << std::endl;
+        return 1;
+    }
+    std::cout << "OK: " << frames << " steady-state frames after " << WARMUP_FRAMES << " warm-up frames, "
+              << satellites.size() << " satellites, no heap allocation" << std::endl;
+    return 0;
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A completed trace zone
+ */
+struct TraceEvent {
+    const char* name;   /*Zone name, must be a string literal*/
+    uint64_t start_ns;  /*Start time since the tracer epoch (ns)*/
+    uint64_t dur_ns;    /*Duration (ns)*/
+};
+
+/**
+ * @brief Trace events of one thread
+ *
+ * Only the owning thread appends, and it publishes each event by bumping the count with
+ * release semantics, so a dump running on another thread can read every event below the
+ * count it acquired without taking a lock. A full buffer drops events and counts them.
+ * Clearing is requested by the dumping thread and carried out by the owner on its next
+ * append, which keeps the owner as the only writer.
+ */
+struct TraceBuffer {
+    static constexpr size_t CAPACITY = 1 << 16;
+
+    explicit TraceBuffer(uint32_t thread_id) : tid(thread_id), events(new TraceEvent[CAPACITY]) {}
+
+    void push(const TraceEvent& event){
+        if (clear_requested.load(std::memory_order_acquire)){
+            count.store(0, std::memory_order_release);
+            dropped.store(0, std::memory_order_relaxed);
+            clear_requested.store(false, std::memory_order_release);
+        }
+        const size_t n = count.load(std::memory_order_relaxed);
+        if (n >= CAPACITY){
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        events[n] = event;
+        count.store(n + 1, std::memory_order_release);
+    }
+
+    const uint32_t tid;
+    std::unique_ptr<TraceEvent[]> events;
+    std::atomic<size_t> count{0};
+    std::atomic<size_t> dropped{0};
+    std::atomic<bool> clear_requested{false};
+    char thread_name[32] = "";
+};
+
+/**
+ * @brief Process-wide trace recorder
+ *
+ * Hands every thread its own TraceBuffer on first use (the only step that takes a lock) and
+ * writes all buffers out as Chrome trace-event JSON, which chrome://tracing and Perfetto
+ * open directly. Recording is off until start() is called, and a disabled zone costs one
+ * relaxed atomic load.
+ */
+class Tracer {
+public:
+    static Tracer& instance(){
+        static Tracer tracer;
+        return tracer;
+    }
+
+    bool recording() const { return active.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Starts recording, discarding anything recorded before
+     */
+    void start(){
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (auto& buffer : buffers){
+            buffer->clear_requested.store(true, std::memory_order_release);
+        }
+        active.store(true, std::memory_order_relaxed);
+    }
+
+    void stop(){
+        active.store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Nanoseconds since the tracer was created
+     */
+    uint64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    /**
+     * @brief Buffer of the calling thread, registered on first use
+     */
+    TraceBuffer& threadBuffer(){
+        thread_local TraceBuffer* buffer = registerThread();
+        return *buffer;
+    }
+
+    /**
+     * @brief Names the calling thread in the trace
+     */
+    void setThreadName(const char* name){
+        TraceBuffer& buffer = threadBuffer();
+        snprintf(buffer.thread_name, sizeof(buffer.thread_name), "%s", name);
+    }
+
+    /**
+     * @brief Writes every recorded event as Chrome trace-event JSON
+     *
+     * Safe to call while other threads keep recording: only the events published before the
+     * dump started are written.
+     *
+     * @param path: Output file path
+     * @return [bool] True if the file was written
+     */
+    bool dump(const char* path){
+        FILE* out = fopen(path, "w");
+        if (!out){
+            perror("fopen");
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+        bool first = true;
+        size_t total_dropped = 0;
+        for (const auto& buffer : buffers){
+            if (buffer->thread_name[0]){
+                fprintf(out, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, "
+                             "\"args\": {\"name\": \"%s\"}}",
+                        first ? "" : ",\n", buffer->tid, buffer->thread_name);
+                first = false;
+            }
+            const size_t n = buffer->clear_requested.load(std::memory_order_acquire)
+                           ? 0 : buffer->count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < n; ++i){
+                const TraceEvent& event = buffer->events[i];
+                fprintf(out, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, "
+                             "\"ts\": %.3f, \"dur\": %.3f}",
+                        first ? "" : ",\n", event.name, buffer->tid, event.start_ns / 1000.0, event.dur_ns / 1000.0);
+                first = false;
+            }
+            total_dropped += buffer->dropped.load(std::memory_order_relaxed);
+        }
+        fprintf(out, "\n]}\n");
+        fclose(out);
+        if (total_dropped){
+            fprintf(stderr, "Trace buffers were full, %zu events dropped\n", total_dropped);
+        }
+        return true;
+    }
+
+private:
+    Tracer() : epoch(std::chrono::steady_clock::now()) {}
+
+    TraceBuffer* registerThread(){
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        buffers.push_back(std::make_unique<TraceBuffer>(static_cast<uint32_t>(buffers.size() + 1)));
+        return buffers.back().get();
+    }
+
+    const std::chrono::steady_clock::time_point epoch;
+    std::atomic<bool> active{false};
+    std::mutex registry_mutex;
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;  /*Owned here so they outlive their threads*/
+};
+
+/**
+ * @brief Records the lifetime of a scope as a trace zone
+ */
+class TraceScope {
+public:
+    explicit TraceScope(const char* zone_name)
+        : name(zone_name), start(Tracer::instance().recording() ? Tracer::instance().now() : NOT_RECORDING) {}
+
+    ~TraceScope(){
+        if (start != NOT_RECORDING){
+            Tracer& tracer = Tracer::instance();
+            tracer.threadBuffer().push({name, start, tracer.now() - start});
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    static constexpr uint64_t NOT_RECORDING = ~0ull;
+    const char* name;
+    const uint64_t start;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+/*Records the enclosing scope as a trace zone named by a string literal*/
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "orbit.hpp"
+#include "trace.hpp"
+
+/*
+ * Binary trajectory layout (little-endian):
+ *
+ *   char magic[8] = "ORBTRAJ", uint32 version, uint32 objects, uint32 ids[objects]
+ *   then one record per block:
+ *   uint32 samples, uint64 steps[samples], float x[samples][objects], float y[samples][objects]
+ */
+constexpr char TRAJECTORY_MAGIC[8] = {'O', 'R', 'B', 'T', 'R', 'A', 'J', '\0'};
+constexpr uint32_t TRAJECTORY_VERSION = 1;
+
+enum class TrajectoryFormat {
+    Binary,     /*Columnar blocks, see the layout above*/
+    Csv         /*One "step,id,x,y" line per object and sample*/
+};
+
+/**
+ * @brief Streams satellite trajectories to disk
+ *
+ * The simulation thread copies the positions of the recorded satellites into the current
+ * block at most every `decimation` steps; a full block is handed to a background thread that
+ * writes it while the simulation fills the other one. Memory is bounded by the two blocks:
+ * when the writer falls behind and both blocks are full, samples are dropped and counted
+ * instead of stalling the simulation, unless the recording was started lossless.
+ */
+class TrajectoryRecorder {
+public:
+    static constexpr size_t BLOCK_BYTES = 4 << 20; /*Target size of one block (bytes)*/
+
+    TrajectoryRecorder() = default;
+    TrajectoryRecorder(const TrajectoryRecorder&) = delete;
+    TrajectoryRecorder& operator=(const TrajectoryRecorder&) = delete;
+
+    ~TrajectoryRecorder(){
+        stop();
+    }
+
+    bool recording() const { return out != nullptr; }
+
+    /**
+     * @brief Number of samples dropped because the writer could not keep up
+     */
+    uint64_t dropped() const { return dropped_samples.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Starts recording
+     *
+     * @param path: Output file path
+     * @param store: Satellite store to record from
+     * @param objects: Indices of the satellites to record, all of them if empty
+     * @param format: File format [TrajectoryFormat]
+     * @param every: Steps between samples [uint64_t]
+     * @param lossless: Wait for the writer instead of dropping samples [bool]
+     * @return [bool] True if recording started
+     */
+    template <typename P>
+    bool start(const std::string& path, const BasicSatelliteStore<P>& store, const std::vector<size_t>& objects,
+               TrajectoryFormat format = TrajectoryFormat::Binary, uint64_t every = 1, bool lossless = false){
+        stop();
+        selected = objects;
+        if (selected.empty()){
+            selected.resize(store.size());
+            for (size_t i = 0; i < selected.size(); ++i){
+                selected[i] = i;
+            }
+        }
+        out = fopen(path.c_str(), format == TrajectoryFormat::Binary ? "wb" : "w");
+        if (!out){
+            perror("fopen");
+            return false;
+        }
+        file_format = format;
+        decimation = std::max<uint64_t>(every, 1);
+        next_sample = 0;
+        wait_for_writer = lossless;
+        dropped_samples.store(0, std::memory_order_relaxed);
+        write_failed = false;
+
+        ids.resize(selected.size());
+        for (size_t k = 0; k < selected.size(); ++k){
+            ids[k] = store.id[selected[k]];
+        }
+        block_samples = std::max<size_t>(1, BLOCK_BYTES / (sizeof(uint64_t) + 2 * sizeof(float) * selected.size()));
+        for (Block& block : blocks){
+            block.steps.resize(block_samples);
+            block.x.resize(block_samples * selected.size());
+            block.y.resize(block_samples * selected.size());
+            block.samples = 0;
+        }
+        filling = 0;
+        pending = false;
+        stopping = false;
+
+        if (file_format == TrajectoryFormat::Binary){
+            const uint32_t objects_count = static_cast<uint32_t>(selected.size());
+            fwrite(TRAJECTORY_MAGIC, 1, sizeof(TRAJECTORY_MAGIC), out);
+            fwrite(&TRAJECTORY_VERSION, sizeof(TRAJECTORY_VERSION), 1, out);
+            fwrite(&objects_count, sizeof(objects_count), 1, out);
+            fwrite(ids.data(), sizeof(uint32_t), ids.size(), out);
+        }
+        else {
+            fprintf(out, "step,id,x,y\n");
+        }
+        writer = std::thread([this]{ writerLoop(); });
+        return true;
+    }
+
+    /**
+     * @brief Samples the store if the current step is due
+     *
+     * Called by the simulation thread after every step.
+     */
+    template <typename P>
+    void record(const BasicSatelliteStore<P>& store){
+        // Time warp can jump over steps, so sample at the first step at or past the due one
+        if (!out || store.clock < next_sample){
+            return;
+        }
+        next_sample = store.clock + decimation;
+        Block& block = blocks[filling];
+        if (block.samples == block_samples){
+            // Both blocks are full, the writer is behind
+            if (wait_for_writer){
+                std::unique_lock<std::mutex> lock(mutex);
+                written.wait(lock, [&]{ return !pending; });
+            }
+            if (!handOff()){
+                dropped_samples.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        Block& target = blocks[filling];
+        const size_t n = selected.size();
+        const size_t base = target.samples * n;
+        target.steps[target.samples] = store.clock;
+        for (size_t k = 0; k < n; ++k){
+            target.x[base + k] = store.x[selected[k]];
+            target.y[base + k] = store.y[selected[k]];
+        }
+        if (++target.samples == block_samples){
+            handOff();
+        }
+    }
+
+    /**
+     * @brief Writes the partial block, waits for the writer and closes the file
+     */
+    void stop(){
+        if (!out){
+            return;
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            written.wait(lock, [&]{ return !pending; });
+            if (blocks[filling].samples){
+                pending = true;
+                filling ^= 1;
+            }
+            stopping = true;
+        }
+        ready.notify_one();
+        writer.join();
+        fclose(out);
+        out = nullptr;
+        if (write_failed){
+            std::cerr << "Trajectory file could not be written completely" << std::endl;
+        }
+        if (dropped()){
+            std::cerr << "Trajectory writer fell behind, " << dropped() << " samples dropped" << std::endl;
+        }
+    }
+
+private:
+    struct Block {
+        size_t samples = 0;
+        std::vector<uint64_t> steps;    /*Step of each sample*/
+        std::vector<float> x, y;        /*Positions, sample-major*/
+    };
+
+    /**
+     * @brief Passes the full block to the writer if it is free
+     *
+     * @return [bool] True if the simulation has an empty block to fill
+     */
+    bool handOff(){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (pending){
+                return false;
+            }
+            pending = true;
+            filling ^= 1;
+        }
+        ready.notify_one();
+        return true;
+    }
+
+    void writerLoop(){
+        Tracer::instance().setThreadName("trajectory");
+        while (true){
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [&]{ return pending || stopping; });
+            if (!pending){
+                return;
+            }
+            // The simulation only touches the other block until pending is cleared
+            Block& block = blocks[filling ^ 1];
+            lock.unlock();
+            writeBlock(block);
+            block.samples = 0;
+            lock.lock();
+            pending = false;
+            const bool done = stopping;
+            lock.unlock();
+            written.notify_one();
+            if (done){
+                return;
+            }
+        }
+    }
+
+    void writeBlock(const Block& block){
+        TRACE_SCOPE("trajectory_write");
+        const size_t n = selected.size();
+        bool ok = true;
+        if (file_format == TrajectoryFormat::Binary){
+            const uint32_t samples = static_cast<uint32_t>(block.samples);
+            ok = fwrite(&samples, sizeof(samples), 1, out) == 1
+              && fwrite(block.steps.data(), sizeof(uint64_t), samples, out) == samples
+              && fwrite(block.x.data(), sizeof(float), samples * n, out) == samples * n
+              && fwrite(block.y.data(), sizeof(float), samples * n, out) == samples * n;
+        }
+        else {
+            for (size_t s = 0; s < block.samples && ok; ++s){
+                for (size_t k = 0; k < n; ++k){
+                    ok = fprintf(out, "%llu,%u,%.3f,%.3f\n", static_cast<unsigned long long>(block.steps[s]),
+                                 ids[k], block.x[s * n + k], block.y[s * n + k]) > 0;
+                }
+            }
+        }
+        write_failed = write_failed || !ok;
+    }
+
+    FILE* out = nullptr;
+    TrajectoryFormat file_format = TrajectoryFormat::Binary;
+    uint64_t decimation = 1;
+    uint64_t next_sample = 0;           /*First step at which the next sample is due*/
+    bool wait_for_writer = false;       /*Stall instead of dropping when the writer is behind*/
+    std::vector<size_t> selected;       /*Store indices of the recorded satellites*/
+    std::vector<uint32_t> ids;          /*Identifiers of the recorded satellites*/
+    size_t block_samples = 0;           /*Samples per block*/
+    Block blocks[2];
+    int filling = 0;                    /*Block the simulation is filling*/
+    bool pending = false;               /*The other block is waiting for or being written*/
+    bool stopping = false;
+    bool write_failed = false;          /*Only touched by the writer while it runs*/
+    std::atomic<uint64_t> dropped_samples{0};
+    std::mutex mutex;
+    std::condition_variable ready;      /*Signals the writer*/
+    std::condition_variable written;    /*Signals the simulation*/
+    std::thread writer;
+};
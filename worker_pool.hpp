@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "arena.hpp"
+#include "trace.hpp"
+
+/**
+ * @brief Fixed pool of worker threads for data-parallel loops
+ *
+ * parallelFor() hands out task indices from a shared counter to the workers and to the
+ * calling thread, which works alongside them and returns once every task is done. Starting a
+ * loop takes one lock and a notification; there is no task queue and nothing is allocated,
+ * so the pool can be used every frame. Each worker resets its own frame arena after every
+ * loop, so tasks may use threadArena() for scratch data.
+ */
+class WorkerPool {
+public:
+    /**
+     * @param n_workers: Threads besides the caller, one less than the hardware threads by default
+     */
+    explicit WorkerPool(unsigned n_workers = std::max(1u, std::thread::hardware_concurrency()) - 1){
+        for (unsigned w = 0; w < n_workers; ++w){
+            workers.emplace_back([this, w]{ workerLoop(w); });
+        }
+    }
+
+    ~WorkerPool(){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers){
+            worker.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief Threads that run tasks, including the caller
+     */
+    size_t threads() const { return workers.size() + 1; }
+
+    /**
+     * @brief Runs fn(i) for every i in [0, n_tasks) and waits for all of them
+     *
+     * @param n_tasks: Number of tasks [size_t]
+     * @param fn: Task body, called concurrently from several threads
+     */
+    template <typename Fn>
+    void parallelFor(size_t n_tasks, Fn&& fn){
+        if (n_tasks == 0){
+            return;
+        }
+        if (workers.empty() || n_tasks == 1){
+            for (size_t i = 0; i < n_tasks; ++i){
+                fn(i);
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = [](void* context, size_t i){ (*static_cast<std::remove_reference_t<Fn>*>(context))(i); };
+            job_context = &fn;
+            job_size = n_tasks;
+            next_task.store(0, std::memory_order_relaxed);
+            busy_workers = workers.size();
+            ++generation;
+        }
+        wake.notify_all();
+        work();
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&]{ return busy_workers == 0; });
+    }
+
+private:
+    void work(){
+        size_t i;
+        while ((i = next_task.fetch_add(1, std::memory_order_relaxed)) < job_size){
+            job(job_context, i);
+        }
+    }
+
+    void workerLoop(unsigned index){
+        char name[32];
+        snprintf(name, sizeof(name), "worker %u", index);
+        Tracer::instance().setThreadName(name);
+        uint64_t seen = 0;
+        while (true){
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]{ return stopping || generation != seen; });
+                if (stopping){
+                    return;
+                }
+                seen = generation;
+            }
+            work();
+            threadArena().reset();
+            bool last;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                last = --busy_workers == 0;
+            }
+            if (last){
+                done.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;       /*Signals the workers that a loop started*/
+    std::condition_variable done;       /*Signals the caller that the workers finished*/
+    void (*job)(void*, size_t) = nullptr;
+    void* job_context = nullptr;
+    size_t job_size = 0;
+    std::atomic<size_t> next_task{0};
+    size_t busy_workers = 0;            /*Workers still in the current loop*/
+    uint64_t generation = 0;            /*Number of loops started*/
+    bool stopping = false;
+};